@@ -0,0 +1,188 @@
+#include "AsyncLogBackend.h"
+#include <cstdio>
+
+namespace {
+
+const size_t kWriteThreshold = 64 * 1024;   // 批量缓冲达到该大小时先写出一次
+
+size_t roundUpPowerOfTwo(size_t n) {
+    size_t result = 2;
+    while (result < n) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+AsyncLogBackend::AsyncLogBackend(size_t capacity, bool consoleOutput)
+    : capacity_(roundUpPowerOfTwo(capacity)),
+      mask_(capacity_ - 1),
+      slots_(new Slot[capacity_]),
+      enqueuePos_(0),
+      dequeuePos_(0),
+      sleeping_(false),
+      stopping_(false),
+      dropped_(0),
+      written_(0),
+      consoleOutput_(consoleOutput),
+      reportedDrops_(0) {
+    for (size_t i = 0; i < capacity_; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    batch_.reserve(kWriteThreshold + 4096);
+    worker_ = std::thread(&AsyncLogBackend::run, this);
+}
+
+AsyncLogBackend::~AsyncLogBackend() {
+    stopping_.store(true);
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        wakeCv_.notify_one();
+    }
+    worker_.join();
+}
+
+std::shared_ptr<AsyncLogBackend> AsyncLogBackend::shared() {
+    static std::shared_ptr<AsyncLogBackend> instance(new AsyncLogBackend());
+    return instance;
+}
+
+bool AsyncLogBackend::submit(LogLevel level, std::chrono::system_clock::time_point time, std::string message) {
+    if (!tryPush(level, time, message)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    // 与后台线程休眠前的检查配对：要么它看到新数据，要么这里看到它在休眠
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        wakeCv_.notify_one();
+    }
+    return true;
+}
+
+void AsyncLogBackend::flush() {
+    const uint64_t target = enqueuePos_.load(std::memory_order_acquire);
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        wakeCv_.notify_one();
+    }
+    while (written_.load(std::memory_order_acquire) < target) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+bool AsyncLogBackend::openFile(const std::string& path) {
+    std::lock_guard<std::mutex> lock(fileMutex_);
+    if (file_.is_open()) {
+        file_.close();
+    }
+    file_.open(path.c_str(), std::ios::app);
+    return file_.is_open();
+}
+
+bool AsyncLogBackend::tryPush(LogLevel level, std::chrono::system_clock::time_point time, std::string& message) {
+    Slot* slot;
+    size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    for (;;) {
+        slot = &slots_[pos & mask_];
+        size_t seq = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+    slot->entry.level = level;
+    slot->entry.time = time;
+    slot->entry.message.swap(message);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool AsyncLogBackend::tryPop(Entry& entry) {
+    // 只有后台线程出队
+    const size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[pos & mask_];
+    if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+        return false;
+    }
+    entry.level = slot.entry.level;
+    entry.time = slot.entry.time;
+    entry.message.swap(slot.entry.message);
+    slot.sequence.store(pos + capacity_, std::memory_order_release);
+    dequeuePos_.store(pos + 1, std::memory_order_relaxed);
+    return true;
+}
+
+void AsyncLogBackend::run() {
+    Entry entry;
+    for (;;) {
+        // 先读退出标志再取数据：退出前提交的日志一定会在最后一轮写出
+        const bool stopping = stopping_.load();
+
+        uint64_t count = 0;
+        while (tryPop(entry)) {
+            append(entry);
+            ++count;
+            if (batch_.size() >= kWriteThreshold) {
+                writeOut();
+            }
+        }
+        const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+        if (dropped != reportedDrops_) {
+            Entry notice;
+            notice.level = WARN;
+            notice.time = std::chrono::system_clock::now();
+            notice.message = "log queue full, dropped " + std::to_string(dropped - reportedDrops_) + " messages";
+            append(notice);
+            reportedDrops_ = dropped;
+        }
+        writeOut();
+        written_.fetch_add(count, std::memory_order_release);
+
+        if (count > 0) {
+            continue;
+        }
+        if (stopping) {
+            break;
+        }
+        std::unique_lock<std::mutex> lock(wakeMutex_);
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        if (slots_[pos & mask_].sequence.load(std::memory_order_acquire) != pos + 1 && !stopping_.load()) {
+            wakeCv_.wait_for(lock, std::chrono::milliseconds(100));
+        }
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+}
+
+void AsyncLogBackend::append(const Entry& entry) {
+    formatter_.append(batch_, entry.level, entry.time, entry.message);
+}
+
+void AsyncLogBackend::writeOut() {
+    if (batch_.empty()) {
+        return;
+    }
+    // 先写文件：终端卡住时已取出的日志至少已经写进文件
+    {
+        std::lock_guard<std::mutex> lock(fileMutex_);
+        if (file_.is_open()) {
+            file_.write(batch_.data(), static_cast<std::streamsize>(batch_.size()));
+            file_.flush();
+        }
+    }
+    if (consoleOutput_) {
+        std::fwrite(batch_.data(), 1, batch_.size(), stdout);
+        std::fflush(stdout);
+    }
+    batch_.clear();
+}
@@ -0,0 +1,80 @@
+#ifndef ASYNC_LOG_BACKEND_H
+#define ASYNC_LOG_BACKEND_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "LogBackend.h"
+#include "LogLineFormatter.h"
+
+// 默认的异步日志后端，进程内所有模块共用一个（shared()）
+//
+// 调用方把日志放进有界无锁环形队列就返回（Vyukov MPSC 算法，槽位预先分配），
+// 队列写满时丢弃并计数，从不等待；后台线程批量取出，格式化时间戳和级别前缀，
+// 每批对标准输出和日志文件各做一次写入并 flush，不再每行 std::endl。
+// 控制台再慢也只会让队列积压、丢弃日志，不会拖慢心跳和定时器线程
+class AsyncLogBackend : public LogBackend {
+public:
+    explicit AsyncLogBackend(size_t capacity = 8192, bool consoleOutput = true);
+    ~AsyncLogBackend();
+
+    // 进程内共享的实例，第一次调用时创建
+    static std::shared_ptr<AsyncLogBackend> shared();
+
+    bool submit(LogLevel level, std::chrono::system_clock::time_point time, std::string message);
+    void flush();
+
+    // 同时追加写入日志文件，失败时返回 false
+    bool openFile(const std::string& path);
+    // 因队列写满被丢弃的条数
+    uint64_t droppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        LogLevel level;
+        std::chrono::system_clock::time_point time;
+        std::string message;
+    };
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        Entry entry;
+    };
+
+    bool tryPush(LogLevel level, std::chrono::system_clock::time_point time, std::string& message);
+    bool tryPop(Entry& entry);
+    void run();
+    void append(const Entry& entry);
+    void writeOut();
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<size_t> enqueuePos_;
+    std::atomic<size_t> dequeuePos_;
+
+    // 后台线程空闲时休眠，只有它在休眠时调用方才需要加锁唤醒
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
+    std::atomic<bool> sleeping_;
+    std::atomic<bool> stopping_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint64_t> written_;     // 已写出的条数，flush() 用它和 enqueuePos_ 比较
+
+    // 以下只由后台线程访问（文件在 fileMutex_ 保护下打开）
+    const bool consoleOutput_;
+    std::mutex fileMutex_;
+    std::ofstream file_;
+    std::string batch_;
+    uint64_t reportedDrops_;
+    LogLineFormatter formatter_;
+
+    std::thread worker_;
+};
+
+#endif // ASYNC_LOG_BACKEND_H
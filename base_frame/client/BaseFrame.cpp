@@ -2,16 +2,18 @@
 #include <iostream>
 #include <fstream>
 #include <chrono>
-#include <ctime>
-#include <iomanip>
 #include <map>
 #include <boost/asio.hpp>  // 添加Boost.Asio库
+#ifdef BASEFRAME_WITH_SHM_LOG
+#include "ShmLogBackend.h"
+#endif
 
 using boost::asio::ip::tcp;  // 添加命名空间声明
 
-
-
-BaseFrame::BaseFrame() : running(false), timerInterval(std::chrono::milliseconds(1000)), currentLogLevel(INFO) {}
+BaseFrame::BaseFrame()
+    : running(false), timerInterval(std::chrono::milliseconds(1000)), currentLogLevel(INFO),
+      logBackend(AsyncLogBackend::shared()), heartbeatConnections(HeartbeatConnectionManager::shared()),
+      heartbeatTransport(HeartbeatTransport::TCP) {}
 
 BaseFrame::~BaseFrame() {
     stopService();
@@ -21,7 +23,7 @@ void BaseFrame::startService() {
     running = true;
     heartbeatThread = std::thread(&BaseFrame::heartbeat, this);
     timerThread = std::thread(&BaseFrame::timer, this);
-    log("Service started.");
+    log(INFO, "Service started.");
 }
 
 void BaseFrame::stopService() {
@@ -29,7 +31,7 @@ void BaseFrame::stopService() {
     cv.notify_all();
     if (heartbeatThread.joinable()) heartbeatThread.join();
     if (timerThread.joinable()) timerThread.join();
-    log("Service stopped.");
+    log(INFO, "Service stopped.");
 }
 
 void BaseFrame::setTimerTask(std::function<void()> task, std::chrono::milliseconds interval) {
@@ -38,76 +40,73 @@ void BaseFrame::setTimerTask(std::function<void()> task, std::chrono::millisecon
     timerInterval = interval;
 }
 
-void BaseFrame::log(const std::string& message, LogLevel level) {
-    if (level < currentLogLevel) return;
-
-    auto now = std::chrono::system_clock::now();
-    auto in_time_t = std::chrono::system_clock::to_time_t(now);
-    std::tm buf;
-    localtime_r(&in_time_t, &buf);
-
-    std::string levelStr;
-    switch (level) {
-        case DEBUG: levelStr = "DEBUG"; break;
-        case INFO: levelStr = "INFO"; break;
-        case WARN: levelStr = "WARN"; break;
-        case ERROR: levelStr = "ERROR"; break;
+void BaseFrame::sendHeartbeat(const std::string& serverAddress, short port, const std::string& moduleName) {
+    std::string error;
+    bool sent = heartbeatTransport.load(std::memory_order_relaxed) == HeartbeatTransport::UDP
+        ? heartbeatConnections->sendDatagram(serverAddress, port, moduleName, error)
+        : heartbeatConnections->send(serverAddress, port, "Heartbeat from " + moduleName, error);
+    if (sent) {
+        log(INFO, "Heartbeat signal sent to server from module: ", moduleName);
+    } else {
+        log(ERROR, "Failed to send heartbeat: ", error);
     }
+}
 
-    std::ostringstream logStream;
-    logStream << "[" << levelStr << "] " << std::put_time(&buf, "%Y-%m-%d %H:%M:%S") << " - " << message;
+void BaseFrame::setHeartbeatTransport(HeartbeatTransport transport) {
+    heartbeatTransport.store(transport, std::memory_order_relaxed);
+}
 
-    std::cout << logStream.str() << std::endl;
-    if (logFile.is_open()) {
-        logFile << logStream.str() << std::endl;
-    }
+void BaseFrame::setLogLevel(LogLevel level) {
+    currentLogLevel.store(level, std::memory_order_relaxed);
 }
 
-void BaseFrame::sendHeartbeat(const std::string& serverAddress, short port, const std::string& moduleName) {
-    try {
-        boost::asio::io_context io_context;
-        tcp::socket socket(io_context);
-        tcp::resolver resolver(io_context);
-        auto endpoints = resolver.resolve(serverAddress, std::to_string(port));
-        boost::asio::connect(socket, endpoints);
-
-        std::string message = "Heartbeat from " + moduleName;
-        boost::asio::write(socket, boost::asio::buffer(message));
-        log("Heartbeat signal sent to server from module: " + moduleName, INFO);
-    } catch (std::exception& e) {
-        log(std::string("Failed to send heartbeat: ") + e.what(), ERROR);
+void BaseFrame::setLogBackend(std::shared_ptr<LogBackend> backend) {
+    if (backend) {
+        logBackend = backend;
     }
 }
 
-void BaseFrame::setLogLevel(LogLevel level) {
-    currentLogLevel = level;
+bool BaseFrame::useLogCollector(const std::string& channel) {
+#ifdef BASEFRAME_WITH_SHM_LOG
+    std::string error;
+    std::shared_ptr<ShmLogBackend> backend = ShmLogBackend::shared(channel, error);
+    if (!backend) {
+        log(ERROR, "Failed to open log channel ", channel, ": ", error);
+        return false;
+    }
+    logBackend = backend;
+    return true;
+#else
+    log(ERROR, "Log collector support is not built in, keeping the current log backend for channel ", channel);
+    return false;
+#endif
 }
 
 void BaseFrame::loadConfig(const std::string& configFilePath) {
-    log("Configuration loaded from " + configFilePath, DEBUG);
+    log(DEBUG, "Configuration loaded from ", configFilePath);
 }
 
 void BaseFrame::checkHealth() {
     while (running) {
-        log("Performing health check...", DEBUG);
+        log(DEBUG, "Performing health check...");
         std::this_thread::sleep_for(std::chrono::seconds(5));
     }
 }
 
 void BaseFrame::notifyEvent(const std::string& event) {
-    log("Event notification: " + event, INFO);
+    log(INFO, "Event notification: ", event);
 }
 
 void BaseFrame::heartbeat() {
     while (running) {
-        log("Heartbeat signal sent.");
+        log(INFO, "Heartbeat signal sent.");
         sendHeartbeat("127.0.0.1", 12345, "ModuleA");  // 发送心跳信号到服务器，添加模块名称
         std::this_thread::sleep_for(std::chrono::seconds(1));
     }
 }
 
 void BaseFrame::handleException() {
-    log("Exception detected, restarting service...");
+    log(INFO, "Exception detected, restarting service...");
     stopService();
     startService();
 }
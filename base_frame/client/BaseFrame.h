@@ -9,9 +9,11 @@
 #include <functional>
 #include <chrono>
 #include <atomic>
+#include <memory>
+#include <string>
 #include <boost/asio.hpp>  // 添加Boost.Asio库
-
-enum LogLevel { DEBUG, INFO, WARN, ERROR };
+#include "AsyncLogBackend.h"
+#include "HeartbeatConnectionManager.h"
 
 class BaseFrame {
 public:
@@ -21,11 +23,39 @@ public:
     void stopService();
     void setTimerTask(std::function<void()> task, std::chrono::milliseconds interval);
     void setLogLevel(LogLevel level);
+    // 替换日志后端，默认使用进程内共享的 AsyncLogBackend::shared()
+    void setLogBackend(std::shared_ptr<LogBackend> backend);
+    // 改用共享内存环把日志交给 logPro 的 logcollector（ShmLogBackend），同一 channel 的各模块进程
+    // 由收集器汇总到一个文件；构建时没有启用 logPro 或创建失败时返回 false，继续使用原来的后端
+    bool useLogCollector(const std::string& channel);
     void loadConfig(const std::string& configFilePath);
+    // 心跳默认走 TCP 长连接，大规模部署时可改用 UDP 数据报
+    void setHeartbeatTransport(HeartbeatTransport transport);
+    // 通过进程内共享的长连接或 UDP 套接字发送，见 HeartbeatConnectionManager
     void sendHeartbeat(const std::string& serverAddress, short port, const std::string& moduleName);  // 声明函数
 
 private:
-    void log(const std::string& message, LogLevel level = INFO);
+    // 先检查级别再拼接消息片段（字符串或数值），时间戳和格式化由日志后端的线程完成：
+    // log(INFO, "Heartbeat signal sent to server from module: ", moduleName);
+    template <typename... Args>
+    void log(LogLevel level, const Args&... args) {
+        if (level < currentLogLevel.load(std::memory_order_relaxed)) return;
+        std::string message;
+        appendPieces(message, args...);
+        logBackend->submit(level, std::chrono::system_clock::now(), std::move(message));
+    }
+
+    static void appendPieces(std::string&) {}
+    template <typename T, typename... Rest>
+    static void appendPieces(std::string& out, const T& first, const Rest&... rest) {
+        appendPiece(out, first);
+        appendPieces(out, rest...);
+    }
+    static void appendPiece(std::string& out, const std::string& piece) { out += piece; }
+    static void appendPiece(std::string& out, const char* piece) { out += piece; }
+    template <typename T>
+    static void appendPiece(std::string& out, const T& piece) { out += std::to_string(piece); }
+
     void heartbeat();
     void handleException();
     void timer();
@@ -39,8 +69,10 @@ private:
     std::condition_variable cv;
     std::function<void()> timerTask;
     std::chrono::milliseconds timerInterval;
-    LogLevel currentLogLevel;
-    std::ofstream logFile;
+    std::atomic<LogLevel> currentLogLevel;
+    std::shared_ptr<LogBackend> logBackend;
+    std::shared_ptr<HeartbeatConnectionManager> heartbeatConnections;
+    std::atomic<HeartbeatTransport> heartbeatTransport;
 };
 
 #endif // BASE_FRAME_H
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include "HeartbeatConnectionManager.h"
+#include <cerrno>
+#include <chrono>
+#include <poll.h>
+#include <sys/socket.h>
+
+using boost::asio::ip::tcp;
+using boost::asio::ip::udp;
+
+namespace {
+
+// 建立 TCP 连接的总时限：服务端所在机器不可达（SYN 无应答）时，
+// 持有连接锁的心跳线程最多等这么久，而不是内核默认的一两分钟
+const std::chrono::milliseconds kConnectTimeout(1000);
+
+// 非阻塞 connect 并用 poll 等到 deadline，成功后恢复阻塞模式供之后的 write 使用。
+// 不能用 socket.connect()：asio 的同步 connect 即使设置了 non_blocking 也会无限期等待
+void connectBefore(tcp::socket& socket, const tcp::endpoint& endpoint,
+                   std::chrono::steady_clock::time_point deadline, boost::system::error_code& ec) {
+    socket.open(endpoint.protocol(), ec);
+    if (ec) {
+        return;
+    }
+    socket.non_blocking(true, ec);
+    if (ec) {
+        return;
+    }
+    if (::connect(socket.native_handle(), endpoint.data(), static_cast<socklen_t>(endpoint.size())) != 0) {
+        if (errno != EINPROGRESS) {
+            ec = boost::system::error_code(errno, boost::asio::error::get_system_category());
+            return;
+        }
+        pollfd pfd;
+        pfd.fd = socket.native_handle();
+        pfd.events = POLLOUT;
+        pfd.revents = 0;
+        for (;;) {
+            long long remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0) {
+                ec = boost::asio::error::timed_out;
+                return;
+            }
+            int rc = ::poll(&pfd, 1, static_cast<int>(remaining));
+            if (rc > 0) {
+                break;
+            }
+            if (rc < 0 && errno != EINTR) {
+                ec = boost::system::error_code(errno, boost::asio::error::get_system_category());
+                return;
+            }
+        }
+        int error = 0;
+        socklen_t length = sizeof(error);
+        if (::getsockopt(pfd.fd, SOL_SOCKET, SO_ERROR, &error, &length) != 0) {
+            error = errno;
+        }
+        if (error != 0) {
+            ec = boost::system::error_code(error, boost::asio::error::get_system_category());
+            return;
+        }
+    }
+    socket.non_blocking(false, ec);
+}
+
+} // namespace
+
+HeartbeatConnectionManager::HeartbeatConnectionManager() {}
+
+std::shared_ptr<HeartbeatConnectionManager> HeartbeatConnectionManager::shared() {
+    static std::shared_ptr<HeartbeatConnectionManager> instance(new HeartbeatConnectionManager());
+    return instance;
+}
+
+bool HeartbeatConnectionManager::send(const std::string& host, short port, const std::string& message, std::string& error) {
+    Connection& connection = connectionFor(host, port);
+    std::lock_guard<std::mutex> lock(connection.mutex);
+
+    std::string line = message;
+    line += '\n';
+    // 已有连接写失败时重连后再试一次；本次新建的连接失败（连不上或写失败）说明服务端不可用，直接返回
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        bool reused = false;
+        try {
+            if (connection.socket.is_open() && peerClosed(connection)) {
+                reset(connection);
+            }
+            if (connection.socket.is_open()) {
+                reused = true;
+            } else {
+                connect(connection, host, port);
+            }
+            // asio 在 Linux 上以 MSG_NOSIGNAL 发送，对端已重置时返回错误而不是 SIGPIPE
+            boost::asio::write(connection.socket, boost::asio::buffer(line));
+            return true;
+        } catch (std::exception& e) {
+            reset(connection);
+            error = e.what();
+            if (!reused) {
+                break;
+            }
+        }
+    }
+    return false;
+}
+
+bool HeartbeatConnectionManager::sendDatagram(const std::string& host, short port, const std::string& moduleName, std::string& error) {
+    Connection& connection = connectionFor(host, port);
+    std::lock_guard<std::mutex> lock(connection.mutex);
+
+    // 发送失败的序号也不回收，服务端会把它计为丢失
+    uint64_t sequence = ++connection.sequences[moduleName];
+    std::string datagram = "Heartbeat " + std::to_string(sequence) + " from " + moduleName;
+    try {
+        if (!connection.datagramSocket.is_open()) {
+            udp::resolver resolver(io_context_);
+            udp::endpoint endpoint = *resolver.resolve(udp::v4(), host, std::to_string(port)).begin();
+            connection.datagramSocket.open(udp::v4());
+            connection.datagramSocket.connect(endpoint);
+        }
+        connection.datagramSocket.send(boost::asio::buffer(datagram));
+        return true;
+    } catch (std::exception& e) {
+        // 下次发送时重新解析并连接（包括服务端未启动时 ICMP 返回的 connection refused）
+        boost::system::error_code ignored;
+        connection.datagramSocket.close(ignored);
+        error = e.what();
+        return false;
+    }
+}
+
+HeartbeatConnectionManager::Connection& HeartbeatConnectionManager::connectionFor(const std::string& host, short port) {
+    std::string key = host + ":" + std::to_string(port);
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_ptr<Connection>& connection = connections_[key];
+    if (!connection) {
+        connection.reset(new Connection(io_context_));
+    }
+    return *connection;
+}
+
+void HeartbeatConnectionManager::connect(Connection& connection, const std::string& host, short port) {
+    if (!connection.resolved) {
+        tcp::resolver resolver(io_context_);
+        connection.endpoints = resolver.resolve(host, std::to_string(port));
+        connection.resolved = true;
+    }
+    // 依次尝试解析出的地址，所有地址共用一个截止时间
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + kConnectTimeout;
+    boost::system::error_code ec = boost::asio::error::host_not_found;
+    for (tcp::resolver::results_type::const_iterator it = connection.endpoints.begin();
+         it != connection.endpoints.end(); ++it) {
+        reset(connection);
+        connectBefore(connection.socket, it->endpoint(), deadline, ec);
+        if (!ec || ec == boost::asio::error::timed_out) {
+            break;
+        }
+    }
+    if (ec) {
+        reset(connection);
+        // 缓存的地址可能已失效，下次连接时重新解析
+        connection.resolved = false;
+        throw boost::system::system_error(ec, "connect");
+    }
+    connection.socket.set_option(tcp::no_delay(true));
+}
+
+// 服务端从不发送数据：读到 EOF 或出错说明连接已不可用，没有数据可读说明连接正常
+bool HeartbeatConnectionManager::peerClosed(Connection& connection) {
+    char byte;
+    ssize_t n = ::recv(connection.socket.native_handle(), &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (n > 0) {
+        return false;
+    }
+    return n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+}
+
+void HeartbeatConnectionManager::reset(Connection& connection) {
+    boost::system::error_code ignored;
+    connection.socket.close(ignored);
+}
@@ -0,0 +1,58 @@
+#ifndef HEARTBEAT_CONNECTION_MANAGER_H
+#define HEARTBEAT_CONNECTION_MANAGER_H
+
+#include <boost/asio.hpp>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// 心跳连接管理：每个服务端地址保持一条长连接，进程内所有模块共用（shared()）
+//
+// 地址只在第一次连接（或连接失败后）解析一次，之后每次心跳只是一次小的 write。
+// 写之前先无阻塞地检查对端是否已关闭（服务端空闲超时、重启），已有连接关闭或写失败时
+// 重新连接并重发一次，对调用方透明；建立连接最多等待 1 秒，新建的连接失败时不再重试，
+// 服务端不可达时每次心跳持有连接锁的时间有上限。
+//
+// UDP 模式下每个服务端地址一个已 connect 的 UDP 套接字，每次心跳只有一次 send，
+// 数据报为 "Heartbeat <序号> from <模块名>"，序号按服务端和模块从 1 递增，服务端据此统计丢包
+enum class HeartbeatTransport { TCP, UDP };
+
+class HeartbeatConnectionManager {
+public:
+    HeartbeatConnectionManager();
+
+    // 进程内共享的实例，第一次调用时创建
+    static std::shared_ptr<HeartbeatConnectionManager> shared();
+
+    // 发送一条消息（自动追加换行），失败时返回 false 并把原因写入 error
+    bool send(const std::string& host, short port, const std::string& message, std::string& error);
+    // 以 UDP 数据报发送模块 moduleName 的一次心跳，失败时返回 false 并把原因写入 error
+    bool sendDatagram(const std::string& host, short port, const std::string& moduleName, std::string& error);
+
+private:
+    struct Connection {
+        explicit Connection(boost::asio::io_context& io_context)
+            : socket(io_context), resolved(false), datagramSocket(io_context) {}
+
+        std::mutex mutex;   // 同一连接上的写入串行化，不同服务端互不影响
+        boost::asio::ip::tcp::socket socket;
+        boost::asio::ip::tcp::resolver::results_type endpoints;
+        bool resolved;
+
+        boost::asio::ip::udp::socket datagramSocket;
+        std::map<std::string, uint64_t> sequences;  // 模块名 -> 上一次发送的序号
+    };
+
+    Connection& connectionFor(const std::string& host, short port);
+    void connect(Connection& connection, const std::string& host, short port);
+    static bool peerClosed(Connection& connection);
+    static void reset(Connection& connection);
+
+    boost::asio::io_context io_context_;
+    std::mutex mutex_;  // 保护 connections_
+    std::map<std::string, std::unique_ptr<Connection>> connections_;
+};
+
+#endif // HEARTBEAT_CONNECTION_MANAGER_H
@@ -0,0 +1,22 @@
+#ifndef LOG_BACKEND_H
+#define LOG_BACKEND_H
+
+#include <chrono>
+#include <string>
+
+enum LogLevel { DEBUG, INFO, WARN, ERROR };
+
+// BaseFrame 的日志输出接口
+// submit() 在心跳、定时器等业务线程中调用，实现必须立即返回，
+// 时间戳格式化和实际的 I/O 都应放到实现自己的线程中
+class LogBackend {
+public:
+    virtual ~LogBackend() {}
+
+    // message 已按级别过滤并拼接好，不含时间戳和级别前缀；返回 false 表示被丢弃
+    virtual bool submit(LogLevel level, std::chrono::system_clock::time_point time, std::string message) = 0;
+    // 等待已提交的日志全部写出
+    virtual void flush() = 0;
+};
+
+#endif // LOG_BACKEND_H
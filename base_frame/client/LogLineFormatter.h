@@ -0,0 +1,60 @@
+#ifndef LOG_LINE_FORMATTER_H
+#define LOG_LINE_FORMATTER_H
+
+#include <chrono>
+#include <ctime>
+#include <string>
+#include "LogBackend.h"
+
+// 日志后端共用的行格式："[LEVEL] YYYY-mm-dd HH:MM:SS.uuuuuu - message\n"
+// 按秒缓存日期时间前缀，每条日志只补写微秒部分；不是线程安全的，每个写出线程各用一个
+class LogLineFormatter {
+public:
+    LogLineFormatter() : cachedSecond_(static_cast<std::time_t>(-1)), cachedLength_(0) {}
+
+    static const char* levelName(LogLevel level) {
+        switch (level) {
+            case DEBUG: return "DEBUG";
+            case INFO: return "INFO";
+            case WARN: return "WARN";
+            case ERROR: return "ERROR";
+        }
+        return "INFO";
+    }
+
+    void append(std::string& out, LogLevel level, std::chrono::system_clock::time_point time,
+                const std::string& message) {
+        long long micros = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count();
+        std::time_t second = static_cast<std::time_t>(micros / 1000000);
+        if (second != cachedSecond_) {
+            std::tm buf;
+            localtime_r(&second, &buf);
+            cachedLength_ = std::strftime(cachedPrefix_, sizeof(cachedPrefix_), "%Y-%m-%d %H:%M:%S", &buf);
+            cachedSecond_ = second;
+        }
+
+        char fraction[8];
+        long value = static_cast<long>(micros % 1000000);
+        fraction[0] = '.';
+        for (int i = 6; i > 0; --i) {
+            fraction[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+
+        out += '[';
+        out += levelName(level);
+        out += "] ";
+        out.append(cachedPrefix_, cachedLength_);
+        out.append(fraction, 7);
+        out += " - ";
+        out += message;
+        out += '\n';
+    }
+
+private:
+    std::time_t cachedSecond_;
+    char cachedPrefix_[32];
+    size_t cachedLength_;
+};
+
+#endif // LOG_LINE_FORMATTER_H
@@ -0,0 +1,54 @@
+#include "ShmLogBackend.h"
+#include <map>
+
+ShmLogBackend::ShmLogBackend() : dropped_(0), reportedDrops_(0) {}
+
+std::shared_ptr<ShmLogBackend> ShmLogBackend::shared(const std::string& channel, std::string& error) {
+    // 实例一直保留到进程退出：环名只由 pid 决定，重新创建会替换掉收集器还没取完的旧环
+    static std::mutex instancesMutex;
+    static std::map<std::string, std::shared_ptr<ShmLogBackend> > instances;
+
+    std::lock_guard<std::mutex> lock(instancesMutex);
+    std::map<std::string, std::shared_ptr<ShmLogBackend> >::iterator it = instances.find(channel);
+    if (it != instances.end()) {
+        return it->second;
+    }
+    std::shared_ptr<ShmLogBackend> backend(new ShmLogBackend());
+    if (!backend->open(channel, error)) {
+        return std::shared_ptr<ShmLogBackend>();
+    }
+    instances[channel] = backend;
+    return backend;
+}
+
+bool ShmLogBackend::open(const std::string& channel, std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!writer_.open(channel)) {
+        error = writer_.error();
+        return false;
+    }
+    return true;
+}
+
+bool ShmLogBackend::submit(LogLevel level, std::chrono::system_clock::time_point time, std::string message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reportedDrops_ &&
+        write(WARN, std::chrono::system_clock::now(),
+              "log ring full, dropped " + std::to_string(dropped - reportedDrops_) + " messages")) {
+        reportedDrops_ = dropped;
+    }
+    if (!write(level, time, message)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool ShmLogBackend::write(LogLevel level, std::chrono::system_clock::time_point time, const std::string& message) {
+    line_.clear();
+    formatter_.append(line_, level, time, message);
+    const uint64_t nanos = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+    return writer_.write(nanos, static_cast<uint32_t>(level), line_.data(), line_.size());
+}
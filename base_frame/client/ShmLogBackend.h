@@ -0,0 +1,45 @@
+#ifndef SHM_LOG_BACKEND_H
+#define SHM_LOG_BACKEND_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "LogBackend.h"
+#include "LogLineFormatter.h"
+#include "shm_log_writer.h"
+
+// 把日志交给 logPro 的 logcollector 统一写出的后端（BaseFrame::useLogCollector）
+//
+// 每个进程一个共享内存环 /logpro.<channel>.<pid>.0，同一台机器上各模块进程的日志
+// 由收集器按时间戳归并到一个文件，轮转、压缩和时间索引都在收集器中完成。
+// submit() 在调用方线程里加锁格式化这一行并 memcpy 进环，不做任何 I/O；
+// 环写满（收集器没有跟上或没有运行）时直接丢弃并计数，从不等待
+class ShmLogBackend : public LogBackend {
+public:
+    ShmLogBackend();
+
+    // 进程内同一 channel 共用一个实例，第一次调用时创建环；失败时返回空指针并设置 error
+    static std::shared_ptr<ShmLogBackend> shared(const std::string& channel, std::string& error);
+
+    bool open(const std::string& channel, std::string& error);
+    bool submit(LogLevel level, std::chrono::system_clock::time_point time, std::string message);
+    // 每条日志在 submit() 中已发布，之后的写出由收集器负责
+    void flush() {}
+
+    // 因环写满被丢弃的条数
+    uint64_t droppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    bool write(LogLevel level, std::chrono::system_clock::time_point time, const std::string& message);
+
+    std::mutex mutex_;
+    ShmLogWriter writer_;
+    LogLineFormatter formatter_;
+    std::string line_;
+    std::atomic<uint64_t> dropped_;
+    uint64_t reportedDrops_;
+};
+
+#endif // SHM_LOG_BACKEND_H
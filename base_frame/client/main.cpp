@@ -1,6 +1,7 @@
 #include "BaseFrame.h"
 #include <iostream>
 #include <csignal>
+#include <cstdlib>
 
 // 定义一个全局的BaseFrame指针用于信号处理
 BaseFrame* globalBaseFrame = nullptr;
@@ -22,6 +23,11 @@ int main() {
     BaseFrame baseFrame;
     globalBaseFrame = &baseFrame;  // 将baseFrame指针赋值给全局变量
 
+    // 设置 BASEFRAME_LOG_CHANNEL 时日志交给同名 channel 的 logcollector 汇总
+    if (const char* channel = std::getenv("BASEFRAME_LOG_CHANNEL")) {
+        baseFrame.useLogCollector(channel);
+    }
+
     // 注册信号处理函数
     std::signal(SIGINT, signalHandler);
 
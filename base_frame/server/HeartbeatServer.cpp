@@ -1,44 +1,205 @@
 #include "HeartbeatServer.h"
 #include <boost/asio.hpp>
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <chrono>
 #include <unordered_map>  // 添加unordered_map库
+#ifdef __linux__
+#include <sys/socket.h>
+#include <cerrno>
+#endif
+
+namespace {
+
+// 连接上超过该时间没有收到任何数据就关闭，比心跳超时（10 秒）长，避免空闲连接一直占用
+const auto kSessionIdleTimeout = std::chrono::seconds(15);
+
+const size_t kDatagramBatch = 64;            // 每次 recvmmsg 最多取出的数据报数
+const size_t kDatagramSize = 512;            // 单个数据报缓冲区大小，超长的数据报被丢弃
+const int kMaxBatchesPerWakeup = 16;         // 每次可读最多取这么多批，之后让出给 TCP 连接和定时器
+const int kDatagramReceiveBuffer = 4 * 1024 * 1024;
+
+// 解析 "Heartbeat <序号> from <模块名>"，没有序号的旧格式 sequence 为 0
+bool parseDatagram(const char* data, size_t length, uint64_t& sequence, const char*& module, size_t& moduleLength) {
+    while (length > 0 && (data[length - 1] == '\n' || data[length - 1] == '\r')) {
+        --length;
+    }
+    static const char kPrefix[] = "Heartbeat ";
+    const size_t prefixLength = sizeof(kPrefix) - 1;
+    if (length < prefixLength || std::char_traits<char>::compare(data, kPrefix, prefixLength) != 0) {
+        return false;
+    }
+    size_t pos = prefixLength;
+    sequence = 0;
+    while (pos < length && data[pos] >= '0' && data[pos] <= '9') {
+        sequence = sequence * 10 + static_cast<uint64_t>(data[pos] - '0');
+        ++pos;
+    }
+    if (pos > prefixLength) {
+        if (pos == length || data[pos] != ' ') {
+            return false;
+        }
+        ++pos;
+    }
+    static const char kFrom[] = "from ";
+    const size_t fromLength = sizeof(kFrom) - 1;
+    if (length - pos <= fromLength || std::char_traits<char>::compare(data + pos, kFrom, fromLength) != 0) {
+        return false;
+    }
+    module = data + pos + fromLength;
+    moduleLength = length - pos - fromLength;
+    return true;
+}
+
+} // namespace
 
 HeartbeatServer::HeartbeatServer(boost::asio::io_context& io_context, short port)
-    : acceptor_(io_context, tcp::endpoint(tcp::v4(), port)), running(true) {
+    : acceptor_(io_context, tcp::endpoint(tcp::v4(), port)),
+      datagramSocket_(io_context, udp::endpoint(udp::v4(), port)),
+      checkTimer_(io_context), running(true),
+      datagramBuffers_(kDatagramBatch * kDatagramSize) {
+    // 心跳突发时由内核缓冲，接收线程每次可读时批量取出
+    boost::system::error_code ignored;
+    datagramSocket_.set_option(boost::asio::socket_base::receive_buffer_size(kDatagramReceiveBuffer), ignored);
+    datagramSocket_.non_blocking(true);
     startAccept();
+    startReceive();
     startHeartbeatCheck();
 }
 
 void HeartbeatServer::stop() {
     running = false;
+    // 监听套接字、定时器和会话都只在 io_context 线程中操作
+    boost::asio::post(acceptor_.get_executor(), [this]() {
+        boost::system::error_code ignored;
+        acceptor_.close(ignored);
+        datagramSocket_.close(ignored);
+        checkTimer_.cancel();
+        auto sessions = sessions_;
+        for (const auto& session : sessions) {
+            session->close();
+        }
+    });
 }
 
 void HeartbeatServer::startAccept() {
-    auto socket = std::make_shared<tcp::socket>(acceptor_.get_executor());
-    acceptor_.async_accept(*socket, [this, socket](boost::system::error_code ec) {
-        if (!ec && running) {
-            std::array<char, 128> buffer;
-            boost::system::error_code error;
-            size_t len = socket->read_some(boost::asio::buffer(buffer), error);
-            if (!error) {
-                std::string message(buffer.data(), len);
-                std::cout << "Heartbeat signal received: " << message << std::endl;
-                // 提取模块名称并更新最后心跳时间
-                std::string moduleName = message.substr(message.find("from ") + 5);
-                lastHeartbeatTimes[moduleName] = std::chrono::steady_clock::now();
-            }
-            startAccept();
-        } else if (running) {
+    acceptor_.async_accept([this](boost::system::error_code ec, tcp::socket socket) {
+        if (!running) {
+            return;
+        }
+        if (!ec) {
+            auto session = std::make_shared<Session>(*this, std::move(socket));
+            sessions_.insert(session);
+            session->start();
+        } else {
             std::cout << "Failed to receive heartbeat signal: " << ec.message() << std::endl;
         }
+        // 单个连接出错不影响继续接受新连接
+        startAccept();
     });
 }
 
+void HeartbeatServer::startReceive() {
+    datagramSocket_.async_wait(udp::socket::wait_read, [this](boost::system::error_code ec) {
+        if (ec || !running) {
+            return;
+        }
+        // 同一批数据报共用一次取时间
+        auto now = std::chrono::steady_clock::now();
+        for (int i = 0; i < kMaxBatchesPerWakeup; ++i) {
+            if (receiveBatch(now) < kDatagramBatch) {
+                break;
+            }
+        }
+        startReceive();
+    });
+}
+
+// 非阻塞地取出一批数据报，返回取到的个数
+size_t HeartbeatServer::receiveBatch(std::chrono::steady_clock::time_point now) {
+#ifdef __linux__
+    mmsghdr messages[kDatagramBatch];
+    iovec vectors[kDatagramBatch];
+    for (size_t i = 0; i < kDatagramBatch; ++i) {
+        vectors[i].iov_base = datagramBuffers_.data() + i * kDatagramSize;
+        vectors[i].iov_len = kDatagramSize;
+        messages[i].msg_hdr = msghdr();
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    int count = ::recvmmsg(datagramSocket_.native_handle(), messages, kDatagramBatch, MSG_DONTWAIT, nullptr);
+    if (count <= 0) {
+        if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            std::cout << "Failed to receive heartbeat datagrams: " << std::strerror(errno) << std::endl;
+        }
+        return 0;
+    }
+    for (int i = 0; i < count; ++i) {
+        if ((messages[i].msg_hdr.msg_flags & MSG_TRUNC) == 0) {
+            handleDatagram(static_cast<const char*>(vectors[i].iov_base), messages[i].msg_len, now);
+        }
+    }
+    return static_cast<size_t>(count);
+#else
+    size_t count = 0;
+    udp::endpoint sender;
+    for (; count < kDatagramBatch; ++count) {
+        boost::system::error_code ec;
+        size_t length = datagramSocket_.receive_from(
+            boost::asio::buffer(datagramBuffers_.data(), kDatagramSize), sender, 0, ec);
+        if (ec) {
+            break;
+        }
+        handleDatagram(datagramBuffers_.data(), length, now);
+    }
+    return count;
+#endif
+}
+
+void HeartbeatServer::handleDatagram(const char* data, size_t length, std::chrono::steady_clock::time_point now) {
+    uint64_t sequence;
+    const char* module;
+    size_t moduleLength;
+    if (!parseDatagram(data, length, sequence, module, moduleLength)) {
+        return;
+    }
+    moduleScratch_.assign(module, moduleLength);
+    lastHeartbeatTimes[moduleScratch_] = now;
+    if (sequence == 0) {
+        return;
+    }
+
+    DatagramStats& stats = datagramStats_[moduleScratch_];
+    if (stats.received == 0 || (sequence == 1 && stats.lastSequence > DatagramStats::kWindow)) {
+        // 第一次收到（服务端可能晚于客户端启动）或客户端重启，从这里开始计数
+        stats.lastSequence = sequence;
+        stats.receivedWindow = 1;
+    } else if (sequence > stats.lastSequence) {
+        const uint64_t shift = sequence - stats.lastSequence;
+        stats.lost += shift - 1;
+        stats.receivedWindow = shift >= DatagramStats::kWindow ? 1 : (stats.receivedWindow << shift) | 1;
+        stats.lastSequence = sequence;
+    } else {
+        const uint64_t offset = stats.lastSequence - sequence;
+        const uint64_t bit = offset < DatagramStats::kWindow ? (uint64_t(1) << offset) : 0;
+        if (bit == 0 || (stats.receivedWindow & bit) != 0) {
+            ++stats.duplicates;
+            return;
+        }
+        // 窗口内第一次到达的迟到数据报，之前已按丢失计入
+        stats.receivedWindow |= bit;
+        if (stats.lost > 0) {
+            --stats.lost;
+        }
+    }
+    ++stats.received;
+}
+
 void HeartbeatServer::startHeartbeatCheck() {
     auto checkInterval = std::chrono::seconds(5);
-    auto timer = std::make_shared<boost::asio::steady_timer>(acceptor_.get_executor(), checkInterval);
-    timer->async_wait([this, timer](boost::system::error_code ec) {
+    checkTimer_.expires_after(checkInterval);
+    checkTimer_.async_wait([this](boost::system::error_code ec) {
         if (!ec && running) {
             auto now = std::chrono::steady_clock::now();
             for (const auto& [moduleName, lastTime] : lastHeartbeatTimes) {
@@ -46,10 +207,111 @@ void HeartbeatServer::startHeartbeatCheck() {
                     std::cout << "No heartbeat signal received from " << moduleName << " for 10 seconds." << std::endl;
                 }
             }
+            for (auto& [moduleName, stats] : datagramStats_) {
+                if (stats.lost != stats.reportedLost || stats.duplicates != stats.reportedDuplicates) {
+                    std::cout << "Heartbeat datagrams from " << moduleName << ": received " << stats.received
+                              << ", lost " << stats.lost << ", duplicates " << stats.duplicates << std::endl;
+                    stats.reportedLost = stats.lost;
+                    stats.reportedDuplicates = stats.duplicates;
+                }
+            }
             startHeartbeatCheck();
         }
     });
 }
 
-// 添加成员变量
-std::unordered_map<std::string, std::chrono::steady_clock::time_point> lastHeartbeatTimes;
\ No newline at end of file
+void HeartbeatServer::handleMessage(const std::string& message) {
+    std::cout << "Heartbeat signal received: " << message << std::endl;
+    // 提取模块名称并更新最后心跳时间
+    size_t pos = message.find("from ");
+    if (pos == std::string::npos || pos + 5 == message.size()) {
+        return;
+    }
+    std::string moduleName = message.substr(pos + 5);
+    lastHeartbeatTimes[moduleName] = std::chrono::steady_clock::now();
+}
+
+void HeartbeatServer::removeSession(const std::shared_ptr<Session>& session) {
+    sessions_.erase(session);
+}
+
+HeartbeatServer::Session::Session(HeartbeatServer& server, tcp::socket socket)
+    : server_(server), socket_(std::move(socket)), deadline_(socket_.get_executor()), used_(0) {
+}
+
+void HeartbeatServer::Session::start() {
+    startRead();
+}
+
+void HeartbeatServer::Session::close() {
+    boost::system::error_code ignored;
+    deadline_.cancel();
+    socket_.shutdown(tcp::socket::shutdown_both, ignored);
+    socket_.close(ignored);
+    server_.removeSession(shared_from_this());
+}
+
+void HeartbeatServer::Session::startRead() {
+    resetDeadline();
+    auto self = shared_from_this();
+    socket_.async_read_some(boost::asio::buffer(buffer_.data() + used_, buffer_.size() - used_),
+        [this, self](const boost::system::error_code& ec, size_t length) {
+            onRead(ec, length);
+        });
+}
+
+void HeartbeatServer::Session::onRead(const boost::system::error_code& ec, size_t length) {
+    if (!socket_.is_open()) {
+        // 已被 close()（超时或 stop()）
+        return;
+    }
+    used_ += length;
+
+    // 逐条处理缓冲区中完整的行，剩余的半条移到开头
+    size_t begin = 0;
+    const char* data = buffer_.data();
+    for (;;) {
+        const char* newline = std::find(data + begin, data + used_, '\n');
+        if (newline == data + used_) {
+            break;
+        }
+        size_t end = newline - data;
+        size_t messageEnd = (end > begin && data[end - 1] == '\r') ? end - 1 : end;
+        if (messageEnd > begin) {
+            server_.handleMessage(std::string(data + begin, messageEnd - begin));
+        }
+        begin = end + 1;
+    }
+    if (begin > 0) {
+        std::copy(buffer_.begin() + begin, buffer_.begin() + used_, buffer_.begin());
+        used_ -= begin;
+    }
+
+    if (ec) {
+        // 对端关闭时，没有换行结尾的最后一条也按完整消息处理
+        if (ec == boost::asio::error::eof && used_ > 0) {
+            server_.handleMessage(std::string(buffer_.data(), used_));
+        } else if (ec != boost::asio::error::eof && ec != boost::asio::error::operation_aborted) {
+            std::cout << "Failed to receive heartbeat signal: " << ec.message() << std::endl;
+        }
+        close();
+        return;
+    }
+    if (used_ == buffer_.size()) {
+        std::cout << "Heartbeat message too long, closing connection." << std::endl;
+        close();
+        return;
+    }
+    startRead();
+}
+
+void HeartbeatServer::Session::resetDeadline() {
+    deadline_.expires_after(kSessionIdleTimeout);
+    std::weak_ptr<Session> weak = shared_from_this();
+    deadline_.async_wait([weak](const boost::system::error_code& ec) {
+        auto self = weak.lock();
+        if (!ec && self) {
+            self->close();
+        }
+    });
+}
@@ -2,25 +2,84 @@
 #define HEARTBEAT_SERVER_H
 
 #include <boost/asio.hpp>
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <memory>
 #include <unordered_map>  // 添加unordered_map库
+#include <unordered_set>
 #include <string>
+#include <vector>
 
 using boost::asio::ip::tcp;
+using boost::asio::ip::udp;
 
+// 心跳服务端：所有连接都在同一个 io_context 线程中异步处理，
+// 任何一个客户端慢或空闲都不会阻塞其他连接的接收和超时检查。
+//
+// 同一端口同时接收 TCP 和 UDP 心跳。UDP 数据报格式为 "Heartbeat <序号> from <模块名>"，
+// 每次可读时用 recvmmsg 批量取出（非 Linux 平台逐个 receive_from），按模块统计收到和丢失的数量，
+// 在每 5 秒的检查中报告丢包
 class HeartbeatServer {
 public:
     HeartbeatServer(boost::asio::io_context& io_context, short port);
+    // 可在任意线程调用：关闭监听和所有连接，io_context 随后自然退出
     void stop();
 
 private:
+    // 一个连接对应一个会话，缓冲区随会话一次分配。
+    // 每条心跳以换行结尾，同一连接上可以连续发送多条；对端关闭时缓冲区中剩余的内容也算一条
+    class Session : public std::enable_shared_from_this<Session> {
+    public:
+        Session(HeartbeatServer& server, tcp::socket socket);
+        void start();
+        void close();
+
+    private:
+        void startRead();
+        void onRead(const boost::system::error_code& ec, size_t length);
+        void resetDeadline();
+
+        HeartbeatServer& server_;
+        tcp::socket socket_;
+        boost::asio::steady_timer deadline_;
+        std::array<char, 512> buffer_;
+        size_t used_;
+    };
+
+    // UDP 心跳按模块统计，序号从 1 开始，回到 1（且已远离窗口）视为客户端重启。
+    // receivedWindow 记录 lastSequence 及之前 63 个序号是否已收到：窗口内第一次到达的迟到数据报
+    // 抵消一次丢失，已收到过的或比窗口更旧的都算作重复，不计入 received
+    struct DatagramStats {
+        static const uint64_t kWindow = 64;
+
+        uint64_t lastSequence = 0;
+        uint64_t receivedWindow = 0;    // 第 i 位对应序号 lastSequence - i
+        uint64_t received = 0;
+        uint64_t lost = 0;
+        uint64_t duplicates = 0;
+        uint64_t reportedLost = 0;
+        uint64_t reportedDuplicates = 0;
+    };
+
     void startAccept();
+    void startReceive();
+    size_t receiveBatch(std::chrono::steady_clock::time_point now);
+    void handleDatagram(const char* data, size_t length, std::chrono::steady_clock::time_point now);
     void startHeartbeatCheck();  // 声明 startHeartbeatCheck 函数
+    void handleMessage(const std::string& message);
+    void removeSession(const std::shared_ptr<Session>& session);
 
     tcp::acceptor acceptor_;
+    udp::socket datagramSocket_;
+    boost::asio::steady_timer checkTimer_;
     std::atomic<bool> running;
     std::unordered_map<std::string, std::chrono::steady_clock::time_point> lastHeartbeatTimes;  // 添加lastHeartbeatTimes变量
+    std::unordered_set<std::shared_ptr<Session>> sessions_;  // 只在 io_context 线程中访问
+    std::unordered_map<std::string, DatagramStats> datagramStats_;
+    std::vector<char> datagramBuffers_;  // kDatagramBatch 个数据报缓冲区，一次分配
+    std::string moduleScratch_;          // 查找模块时复用，避免每个数据报分配字符串
 };
 
-#endif // HEARTBEAT_SERVER_H
\ No newline at end of file
+#endif // HEARTBEAT_SERVER_H
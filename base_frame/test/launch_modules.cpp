@@ -1,3 +1,4 @@
+#include <cstdlib>
 #include <iostream>
 #include "ModuleB.h"
 #include "ModuleC.h"
@@ -6,6 +7,12 @@ int main() {
     ModuleB moduleB;
     ModuleC moduleC;
 
+    // 设置 BASEFRAME_LOG_CHANNEL 时两个模块的日志都交给 logcollector，与其他进程的日志汇总到一个文件
+    if (const char* channel = std::getenv("BASEFRAME_LOG_CHANNEL")) {
+        moduleB.useLogCollector(channel);
+        moduleC.useLogCollector(channel);
+    }
+
     std::cout << "Starting ModuleB..." << std::endl;
     moduleB.startService();
     moduleB.registerModule();
@@ -0,0 +1,52 @@
+#!/bin/bash
+
+# UDP 心跳丢包统计测试：重复或重放的数据报不能抵消真实的丢失
+#   DupModule     1 2 4 4 4  -> 收到 3，丢失 1，重复 2（重复最新的序号）
+#   ReplayModule  1 2 3 5 3  -> 收到 4，丢失 1，重复 1（重放较旧的序号，4 仍然丢失）
+#   LateModule    1 2 4 3 3  -> 收到 4，丢失 0，重复 1（3 迟到一次抵消丢失，第二次算重复）
+
+# 项目根目录默认为脚本所在目录的上一级，服务端程序可用 SERVER_BIN 指定
+PROJECT_ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+SERVER_BIN="${SERVER_BIN:-$PROJECT_ROOT/server/build/ServerDemo}"
+OUTPUT="$(mktemp)"
+
+echo "Starting server..."
+"$SERVER_BIN" > "$OUTPUT" 2>&1 &
+SERVER_PID=$!
+sleep 1
+
+send() {
+    local module=$1
+    shift
+    for seq in "$@"; do
+        printf 'Heartbeat %s from %s' "$seq" "$module" > /dev/udp/127.0.0.1/12345
+    done
+}
+
+send DupModule 1 2 4 4 4
+send ReplayModule 1 2 3 5 3
+send LateModule 1 2 4 3 3
+
+# 服务端每 5 秒检查一次并报告丢包
+sleep 6
+kill "$SERVER_PID"
+wait "$SERVER_PID" 2>/dev/null
+
+STATUS=0
+for EXPECTED in \
+    "Heartbeat datagrams from DupModule: received 3, lost 1, duplicates 2" \
+    "Heartbeat datagrams from ReplayModule: received 4, lost 1, duplicates 1" \
+    "Heartbeat datagrams from LateModule: received 4, lost 0, duplicates 1"; do
+    if grep -q "$EXPECTED" "$OUTPUT"; then
+        echo "PASS: $EXPECTED"
+    else
+        echo "FAIL: expected \"$EXPECTED\""
+        STATUS=1
+    fi
+done
+if [ "$STATUS" -ne 0 ]; then
+    echo "Server output:"
+    cat "$OUTPUT"
+fi
+rm -f "$OUTPUT"
+exit "$STATUS"
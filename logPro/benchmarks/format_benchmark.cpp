@@ -0,0 +1,174 @@
+// 格式化基准测试：对比原先 ostringstream + vector<string> 的 formatMessage
+// 与编译期格式串 + std::to_chars 的路径，统计每条日志的堆分配次数和耗时
+//
+// 用法: format_benchmark [迭代次数]
+
+#include "log_record.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{0};
+
+struct Point {
+    int x;
+    int y;
+};
+
+// 只有 operator<< 的用户类型走 to_string_helper
+std::ostream& operator<<(std::ostream& os, const Point& p) {
+    return os << '(' << p.x << ", " << p.y << ')';
+}
+
+// 原先的实现：每个参数一个 ostringstream，再用 vector<string> 和 ostringstream 拼接
+template<typename... Args>
+std::string formatMessage(const std::string& format, Args&&... args) {
+    std::vector<std::string> arg_strings = { to_string_helper(std::forward<Args>(args))... };
+    std::ostringstream oss;
+    size_t arg_index = 0;
+    size_t pos = 0;
+    size_t placeholder = format.find("{}", pos);
+
+    while (placeholder != std::string::npos) {
+        oss << format.substr(pos, placeholder - pos);
+        if (arg_index < arg_strings.size()) {
+            oss << arg_strings[arg_index++];
+        } else {
+            oss << "{}";
+        }
+        pos = placeholder + 2;
+        placeholder = format.find("{}", pos);
+    }
+    oss << format.substr(pos);
+    return oss.str();
+}
+
+struct Result {
+    double allocations_per_call;
+    double ns_per_call;
+};
+
+template<typename Fn>
+Result measure(int iterations, Fn&& fn) {
+    fn();  // 预热，让可复用的缓冲区先达到最终容量
+    uint64_t before = g_allocations.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    uint64_t allocations = g_allocations.load(std::memory_order_relaxed) - before;
+    return Result{static_cast<double>(allocations) / iterations, elapsed / iterations};
+}
+
+// 新路径：调用方把参数编码进暂存区（PerThread 模式的字节环），后台线程按段表追加到复用的批量缓冲
+template<FixedString Fmt, typename... Args>
+void encodeAndRender(char* staging, std::string& batch, const Args&... args) {
+    using Codec = ArgCodec<StoredArg<Args>...>;
+    Codec::encode(staging, args...);
+    batch.clear();
+    batch += "[INFO] ";
+    CallSite<Fmt, StoredArg<Args>...>::format(staging, batch);
+}
+
+// 结构化字段的 JSON 行：键在调用点中，记录里只有值
+template<FixedString Fmt, typename... Args>
+void encodeAndRenderJson(char* staging, std::string& batch, const Args&... args) {
+    using Codec = ArgCodec<StoredArg<Args>...>;
+    Codec::encode(staging, args...);
+    batch.clear();
+    batch += "{\"level\":\"INFO\",";
+    CallSite<Fmt, StoredArg<Args>...>::json(staging, batch);
+    batch += "}\n";
+}
+
+void print(const char* name, const Result& r) {
+    std::printf("%-34s %12.2f %12.1f\n", name, r.allocations_per_call, r.ns_per_call);
+}
+
+} // namespace
+
+template<>
+struct LogFormatter<Point> {
+    static void format(const Point& p, FormatBuffer& out) {
+        out.push_back('(');
+        appendValue(out, p.x);
+        out.append(", ");
+        appendValue(out, p.y);
+        out.push_back(')');
+    }
+};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+    const int user_id = 42;
+    const std::string action = "checkout-with-saved-card";
+    const double duration = 0.1375;
+    const Point point{3, -7};
+
+    char staging[512];
+    std::string batch;
+    batch.reserve(4096);
+
+    std::printf("%-34s %12s %12s\n", "path", "allocs/call", "ns/call");
+
+    print("ostream: int, string, double", measure(iterations, [&]() {
+        std::string line = std::string("[INFO] ") +
+            formatMessage("User {} performed {} in {} seconds.", user_id, action, duration);
+        (void)line;
+    }));
+    print("to_chars: int, string, double", measure(iterations, [&]() {
+        encodeAndRender<"User {} performed {} in {} seconds.">(staging, batch, user_id, action, duration);
+    }));
+
+    print("ostream: user type", measure(iterations, [&]() {
+        std::string line = std::string("[INFO] ") + formatMessage("moved to {}", point);
+        (void)line;
+    }));
+    print("to_chars: user type (LogFormatter)", measure(iterations, [&]() {
+        encodeAndRender<"moved to {}">(staging, batch, prepareArg(point));
+    }));
+
+    print("to_chars: kv fields (key=value)", measure(iterations, [&]() {
+        encodeAndRender<"checkout done">(staging, batch, kv<"user_id">(user_id), kv<"action">(action),
+                                         kv<"duration">(duration));
+    }));
+    print("to_chars: kv fields (JSON)", measure(iterations, [&]() {
+        encodeAndRenderJson<"checkout done">(staging, batch, kv<"user_id">(user_id), kv<"action">(action),
+                                             kv<"duration">(duration));
+    }));
+
+    // Shared 模式的记录从缓冲区池取参数缓冲区，析构时归还
+    RecordBufferPool pool(256, 64);
+    print("shared queue record payload", measure(iterations, [&]() {
+        using Codec = ArgCodec<int, std::string, double>;
+        LogRecord record;
+        record.payload = pool.acquire(Codec::size(user_id, action, duration));
+        Codec::encode(record.payload.data(), user_id, action, duration);
+    }));
+    return 0;
+}
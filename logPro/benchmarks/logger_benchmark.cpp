@@ -0,0 +1,373 @@
+// Logger 端到端基准测试，结果以 JSON 输出，便于对比不同的队列、格式化和输出实现
+//
+//   latency       固定速率和突发两种负载下单次 log() 调用的 p50/p99/p99.9/max
+//   throughput    1-64 个生产者线程的最大持续吞吐（含后台线程写完全部数据的时间），附 Logger::metrics() 的最大积压和入队 p99
+//   backend_lag   从调用 log() 到该行到达输出目标的延迟
+//   allocations   调用方线程每次 log() 的堆分配次数
+//   call_site     限流被压制和采样未命中时宏本身的开销
+//
+// 用法: logger_benchmark [--mode shared|perthread] [--format text|binary] [--write write|mmap]
+//                        [--shards 后台线程数] [--messages N] [--rate 每秒条数] [--file 日志文件] [-o result.json]
+
+#include "logger.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 只统计当前线程的分配，后台线程和输出线程的分配不计入调用方
+thread_local uint64_t t_allocations = 0;
+
+struct Config {
+    QueueMode queue_mode = QueueMode::Shared;
+    LogFormat format = LogFormat::Text;
+    FileWriteMode write_mode = FileWriteMode::Write;
+    int shards = 1;
+    int messages = 200000;          // 每个线程的消息数
+    int latency_threads = 4;
+    double rate = 100000;           // 固定速率负载的总速率（条/秒）
+    int burst_size = 1000;
+    std::string file = "logger_benchmark.log";
+    std::string output;
+};
+
+struct Percentiles {
+    double p50 = 0;
+    double p99 = 0;
+    double p999 = 0;
+    double max = 0;
+};
+
+Percentiles percentiles(std::vector<uint64_t>& samples) {
+    Percentiles result;
+    if (samples.empty()) {
+        return result;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double p) {
+        return static_cast<double>(samples[static_cast<size_t>(p * (samples.size() - 1))]);
+    };
+    result.p50 = at(0.50);
+    result.p99 = at(0.99);
+    result.p999 = at(0.999);
+    result.max = static_cast<double>(samples.back());
+    return result;
+}
+
+uint64_t nowNanos() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count());
+}
+
+// 解析探测行里的发送时间，计算到达输出目标的延迟
+class LagSink : public LogSink {
+public:
+    LagSink() : LogSink(LogLevel::DEBUG, 1024) {}
+
+    std::vector<uint64_t> samples;
+
+protected:
+    void writeText(std::string_view text) override {
+        const uint64_t now = nowNanos();
+        static constexpr std::string_view kMarker = "lag probe ";
+        size_t pos = 0;
+        while ((pos = text.find(kMarker, pos)) != std::string_view::npos) {
+            pos += kMarker.size();
+            uint64_t sent = 0;
+            while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+                sent = sent * 10 + static_cast<uint64_t>(text[pos++] - '0');
+            }
+            samples.push_back(now - sent);
+        }
+    }
+};
+
+LoggerOptions makeOptions(const Config& config) {
+    LoggerOptions options;
+    options.queue_mode = config.queue_mode;
+    options.format = config.format;
+    options.file_write_mode = config.write_mode;
+    options.backend_threads = static_cast<size_t>(config.shards);
+    options.console_output = false;
+    options.rotation.max_file_size = 0;
+    options.rotation.compress = false;
+    return options;
+}
+
+void removeLogFile(const Config& config) {
+    std::error_code ec;
+    for (int i = 0; i < config.shards; ++i) {
+        std::filesystem::remove(shardFileName(config.file, i, config.shards), ec);
+    }
+}
+
+// 固定速率：每个线程按 rate / threads 的间隔忙等发出下一条；突发：每次连续发 burst_size 条后休息 5ms
+Percentiles measureLatency(const Config& config, bool burst) {
+    removeLogFile(config);
+    std::vector<std::vector<uint64_t>> samples(config.latency_threads);
+    {
+        Logger logger(config.file, makeOptions(config));
+        const auto interval = std::chrono::nanoseconds(
+            static_cast<int64_t>(1e9 * config.latency_threads / config.rate));
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < config.latency_threads; ++t) {
+            threads.emplace_back([&, t]() {
+                auto& local = samples[t];
+                local.reserve(config.messages);
+                auto next = Clock::now();
+                for (int i = 0; i < config.messages; ++i) {
+                    if (burst) {
+                        if (i % config.burst_size == 0 && i > 0) {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                        }
+                    } else {
+                        while (Clock::now() < next) {
+                            cpuRelax();
+                        }
+                        next += interval;
+                    }
+                    auto begin = Clock::now();
+                    logger.log<"bench thread {} message {} value {}">(LogLevel::INFO, t, i, 3.25);
+                    auto end = Clock::now();
+                    local.push_back(static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    std::vector<uint64_t> all;
+    for (auto& local : samples) {
+        all.insert(all.end(), local.begin(), local.end());
+    }
+    return percentiles(all);
+}
+
+struct ThroughputResult {
+    int threads;
+    double msgs_per_sec;
+    uint64_t dropped;
+    uint64_t max_queue_depth;       // Logger::metrics() 中各分片观察到的最大积压
+    uint64_t enqueue_p99_ns;
+};
+
+ThroughputResult measureThroughput(const Config& config, int num_threads) {
+    removeLogFile(config);
+    const int per_thread = std::max(1, config.messages / num_threads);
+    LoggerMetrics metrics;
+    auto start = Clock::now();
+    {
+        Logger logger(config.file, makeOptions(config));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < per_thread; ++i) {
+                    logger.log<"bench thread {} message {} value {}">(LogLevel::INFO, t, i, 3.25);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        metrics = logger.metrics();
+    }
+    // Logger 析构时等待后台线程写完，计时包含全部数据落到文件
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    return ThroughputResult{num_threads, static_cast<double>(per_thread) * num_threads / elapsed, metrics.dropped,
+                            metrics.max_queue_depth, metrics.enqueue_latency.percentile(0.99)};
+}
+
+Percentiles measureBackendLag(const Config& config) {
+    removeLogFile(config);
+    auto sink = std::make_shared<LagSink>();
+    {
+        LoggerOptions options = makeOptions(config);
+        options.sinks.push_back(sink);
+        Logger logger(config.file, options);
+        const auto interval = std::chrono::nanoseconds(static_cast<int64_t>(1e9 / config.rate));
+        auto next = Clock::now();
+        const int probes = std::min(config.messages, 50000);
+        for (int i = 0; i < probes; ++i) {
+            while (Clock::now() < next) {
+                cpuRelax();
+            }
+            next += interval;
+            logger.log<"lag probe {}">(LogLevel::INFO, nowNanos());
+        }
+    }
+    return percentiles(sink->samples);
+}
+
+struct AllocationResult {
+    double per_call;
+    uint64_t pool_overflows;    // Shared 模式下参数缓冲区池取空后退回堆分配的次数
+};
+
+AllocationResult measureAllocations(const Config& config) {
+    removeLogFile(config);
+    Logger logger(config.file, makeOptions(config));
+    const std::string action = "checkout-with-saved-card";
+    // 预热：PerThread 模式第一次调用会注册本线程的暂存缓冲区
+    logger.log<"user {} performed {} in {} seconds">(LogLevel::INFO, 42, action, 0.125);
+    const uint64_t before = t_allocations;
+    for (int i = 0; i < config.messages; ++i) {
+        logger.log<"user {} performed {} in {} seconds">(LogLevel::INFO, i, action, 0.125);
+    }
+    return AllocationResult{static_cast<double>(t_allocations - before) / config.messages,
+                            logger.recordPoolOverflows()};
+}
+
+struct CallSiteCost {
+    double rate_limited_ns;
+    double sampled_ns;
+};
+
+// 限流/采样宏在日志风暴中的开销：绝大多数调用在检查处就返回
+CallSiteCost measureCallSiteChecks(const Config& config) {
+    removeLogFile(config);
+    Logger logger(config.file, makeOptions(config));
+    const int iterations = config.messages * 10;
+
+    auto begin = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        LOG_RATE_LIMITED(logger, LogLevel::WARN, 10, "storm {}", i);
+    }
+    auto middle = Clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        LOG_SAMPLED(logger, LogLevel::INFO, 0.0001, "sampled {}", i);
+    }
+    auto end = Clock::now();
+
+    return CallSiteCost{
+        std::chrono::duration<double, std::nano>(middle - begin).count() / iterations,
+        std::chrono::duration<double, std::nano>(end - middle).count() / iterations};
+}
+
+const char* modeName(QueueMode mode) {
+    return mode == QueueMode::PerThread ? "perthread" : "shared";
+}
+
+bool parseArgs(int argc, char* argv[], Config& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--mode") {
+            config.queue_mode = value == "perthread" ? QueueMode::PerThread : QueueMode::Shared;
+        } else if (arg == "--format") {
+            config.format = value == "binary" ? LogFormat::Binary : LogFormat::Text;
+        } else if (arg == "--write") {
+            config.write_mode = value == "mmap" ? FileWriteMode::Mmap : FileWriteMode::Write;
+        } else if (arg == "--shards") {
+            config.shards = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--messages") {
+            config.messages = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--rate") {
+            config.rate = std::max(1.0, std::atof(value.c_str()));
+        } else if (arg == "--file") {
+            config.file = value;
+        } else if (arg == "-o") {
+            config.output = value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void printPercentiles(FILE* out, const char* name, const Percentiles& p, const char* suffix) {
+    std::fprintf(out, "    \"%s\": {\"p50_ns\": %.0f, \"p99_ns\": %.0f, \"p999_ns\": %.0f, \"max_ns\": %.0f}%s\n",
+                 name, p.p50, p.p99, p.p999, p.max, suffix);
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    ++t_allocations;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char* argv[]) {
+    Config config;
+    if (!parseArgs(argc, argv, config)) {
+        std::fprintf(stderr, "用法: logger_benchmark [--mode shared|perthread] [--format text|binary] "
+                             "[--write write|mmap] [--shards 后台线程数] [--messages N] [--rate 每秒条数] [--file 日志文件] [-o result.json]\n");
+        return 2;
+    }
+
+    Percentiles fixed_rate = measureLatency(config, false);
+    Percentiles burst = measureLatency(config, true);
+    std::vector<ThroughputResult> throughput;
+    for (int threads : {1, 2, 4, 8, 16, 32, 64}) {
+        throughput.push_back(measureThroughput(config, threads));
+    }
+    Percentiles lag = measureBackendLag(config);
+    AllocationResult allocations = measureAllocations(config);
+    CallSiteCost call_site = measureCallSiteChecks(config);
+    removeLogFile(config);
+
+    FILE* out = stdout;
+    if (!config.output.empty() && (out = std::fopen(config.output.c_str(), "w")) == nullptr) {
+        std::fprintf(stderr, "无法创建输出文件: %s\n", config.output.c_str());
+        return 1;
+    }
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"config\": {\"queue_mode\": \"%s\", \"format\": \"%s\", \"write_mode\": \"%s\", \"shards\": %d, "
+                      "\"messages_per_thread\": %d, \"latency_threads\": %d, \"rate\": %.0f, \"burst_size\": %d},\n",
+                 modeName(config.queue_mode), config.format == LogFormat::Binary ? "binary" : "text",
+                 config.write_mode == FileWriteMode::Mmap ? "mmap" : "write", config.shards,
+                 config.messages, config.latency_threads, config.rate, config.burst_size);
+    std::fprintf(out, "  \"latency\": {\n");
+    printPercentiles(out, "fixed_rate", fixed_rate, ",");
+    printPercentiles(out, "burst", burst, "");
+    std::fprintf(out, "  },\n");
+    std::fprintf(out, "  \"throughput\": [\n");
+    for (size_t i = 0; i < throughput.size(); ++i) {
+        std::fprintf(out, "    {\"threads\": %d, \"msgs_per_sec\": %.0f, \"dropped\": %llu, "
+                          "\"max_queue_depth\": %llu, \"enqueue_p99_ns\": %llu}%s\n",
+                     throughput[i].threads, throughput[i].msgs_per_sec,
+                     static_cast<unsigned long long>(throughput[i].dropped),
+                     static_cast<unsigned long long>(throughput[i].max_queue_depth),
+                     static_cast<unsigned long long>(throughput[i].enqueue_p99_ns),
+                     i + 1 < throughput.size() ? "," : "");
+    }
+    std::fprintf(out, "  ],\n");
+    std::fprintf(out, "  \"backend_lag\": {\"p50_ns\": %.0f, \"p99_ns\": %.0f, \"p999_ns\": %.0f, \"max_ns\": %.0f},\n",
+                 lag.p50, lag.p99, lag.p999, lag.max);
+    std::fprintf(out, "  \"allocations_per_call\": %.3f,\n", allocations.per_call);
+    std::fprintf(out, "  \"record_pool_overflows\": %llu,\n",
+                 static_cast<unsigned long long>(allocations.pool_overflows));
+    std::fprintf(out, "  \"call_site\": {\"rate_limited_ns\": %.2f, \"sampled_ns\": %.2f}\n",
+                 call_site.rate_limited_ns, call_site.sampled_ns);
+    std::fprintf(out, "}\n");
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    return 0;
+}
@@ -0,0 +1,165 @@
+// LogQueue 基准测试：对比原先基于 std::mutex + condition_variable 的队列
+// 与无锁 MPSC 环形队列在 1-64 个生产者线程下的单次 push 延迟和吞吐量
+//
+// 用法: queue_benchmark [每个线程的消息数]
+
+#include "log_queue.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 原先的实现：每次 push 加锁并 notify_one
+template<typename T>
+class MutexLogQueue {
+public:
+    void push(const T msg) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push(msg);
+        cond_var_.notify_one();
+    }
+
+    bool pop(T& msg) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_var_.wait(lock, [this]() {
+            return !queue_.empty() || is_shutdown_;
+        });
+        if (queue_.empty()) {
+            return false;
+        }
+        msg = queue_.front();
+        queue_.pop();
+        return true;
+    }
+
+    void shutdown() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_shutdown_ = true;
+        cond_var_.notify_all();
+    }
+
+private:
+    std::queue<T> queue_;
+    std::mutex mutex_;
+    std::condition_variable cond_var_;
+    bool is_shutdown_ = false;
+};
+
+struct Result {
+    double p50_ns;
+    double p99_ns;
+    double p999_ns;
+    double max_ns;
+    double throughput;  // 条/秒
+};
+
+double percentile(const std::vector<uint64_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1));
+    return static_cast<double>(sorted[index]);
+}
+
+// 原先的队列传递拼好的字符串
+struct StringMessage {
+    using Item = std::string;
+    using Queue = MutexLogQueue<std::string>;
+
+    Item make() const { return std::string(24, 'x'); }
+};
+
+// 新队列传递记录头加池化的参数缓冲区（一个 int 参数加一个短字符串参数，共 24 字节）
+struct PooledRecord {
+    using Item = LogRecord;
+    using Queue = LogQueue;
+
+    RecordBufferPool pool{256, 8192};
+
+    Item make() {
+        LogRecord record;
+        record.header = RecordHeader{0, &CallSite<"Thread {} writing log message {}", int, std::string>::info,
+                                     24, LogLevel::INFO};
+        record.payload = pool.acquire(24);
+        std::memset(record.payload.data(), 'x', 24);
+        return record;
+    }
+};
+
+template<typename Message>
+Result run(int num_threads, int messages_per_thread) {
+    using Clock = std::chrono::steady_clock;
+    typename Message::Queue queue;
+    Message message;
+    std::vector<std::vector<uint64_t>> latencies(num_threads);
+
+    std::thread consumer([&queue]() {
+        typename Message::Item msg;
+        while (queue.pop(msg)) {
+        }
+    });
+
+    auto start = Clock::now();
+    std::vector<std::thread> producers;
+    for (int t = 0; t < num_threads; ++t) {
+        producers.emplace_back([&, t]() {
+            auto& samples = latencies[t];
+            samples.reserve(messages_per_thread);
+            for (int i = 0; i < messages_per_thread; ++i) {
+                auto begin = Clock::now();
+                queue.push(message.make());
+                auto end = Clock::now();
+                samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    queue.shutdown();
+    consumer.join();
+    auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<uint64_t> all;
+    all.reserve(static_cast<size_t>(num_threads) * messages_per_thread);
+    for (auto& samples : latencies) {
+        all.insert(all.end(), samples.begin(), samples.end());
+    }
+    std::sort(all.begin(), all.end());
+
+    Result result;
+    result.p50_ns = percentile(all, 0.50);
+    result.p99_ns = percentile(all, 0.99);
+    result.p999_ns = percentile(all, 0.999);
+    result.max_ns = all.empty() ? 0 : static_cast<double>(all.back());
+    result.throughput = all.size() / elapsed;
+    return result;
+}
+
+void print(const char* name, int threads, const Result& r) {
+    std::printf("%-8s %7d %10.0f %10.0f %10.0f %12.0f %14.0f\n",
+                name, threads, r.p50_ns, r.p99_ns, r.p999_ns, r.max_ns, r.throughput);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int messages_per_thread = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+    std::printf("%-8s %7s %10s %10s %10s %12s %14s\n",
+                "queue", "threads", "p50(ns)", "p99(ns)", "p99.9(ns)", "max(ns)", "msgs/s");
+    for (int threads : {1, 2, 4, 8, 16, 32, 64}) {
+        print("mutex", threads, run<StringMessage>(threads, messages_per_thread));
+        print("mpsc", threads, run<PooledRecord>(threads, messages_per_thread));
+    }
+    return 0;
+}
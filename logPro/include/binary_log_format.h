@@ -0,0 +1,72 @@
+#ifndef BINARY_LOG_FORMAT_H
+#define BINARY_LOG_FORMAT_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// 二进制日志文件格式
+//
+//   文件 = FileHeader Block*
+//   Block = BlockHeader 字典段 记录段
+//   字典条目 = varint id, u8 参数个数, 参数个数 × u8 ArgType, varint 格式串长度, 格式串,
+//              u8 字段个数, 字段个数 × (varint 键长度, 键)
+//   参数个数包括消息参数和跟在后面的字段，前 参数个数 - 字段个数 个填入格式串的占位符
+//   记录 = varint id, u8 level, zigzag varint 时间戳增量, varint payload 长度, payload
+//
+// 每个格式串（调用点）在一个文件中只写一次字典条目，之后的记录只引用 id。
+// 时间戳为自 epoch 起的纳秒，记录只保存与前一条记录的差值（块内第一条相对 base_timestamp）。
+// 块头记录本块的时间范围和各段长度，解码器可以不解析记录就跳过整个块，
+// 先顺序扫描所有块头和字典，再并行解码各块。
+namespace binlog {
+
+constexpr char kFileMagic[4] = {'L', 'P', 'B', 'L'};
+constexpr uint32_t kFileVersion = 3;   // 2：LogLevel 按严重程度重新编号；3：字典条目带字段名
+constexpr uint32_t kBlockMagic = 0x4B4C4250;  // "PBLK"
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+};
+
+struct BlockHeader {
+    uint32_t magic;
+    uint32_t record_count;
+    uint32_t dict_size;
+    uint32_t records_size;
+    uint64_t base_timestamp;
+    uint64_t min_timestamp;
+    uint64_t max_timestamp;
+};
+
+inline void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+inline bool getVarint(const char*& ptr, const char* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && ptr < end; shift += 7) {
+        uint8_t byte = static_cast<uint8_t>(*ptr++);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline uint64_t zigzagEncode(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+} // namespace binlog
+
+#endif // BINARY_LOG_FORMAT_H
@@ -0,0 +1,68 @@
+#ifndef BINARY_LOG_READER_H
+#define BINARY_LOG_READER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "binary_log_format.h"
+#include "log_clock.h"
+#include "log_record.h"
+
+// 记录过滤条件，时间为自 epoch 起的纳秒，区间为 [from, to]
+struct RecordFilter {
+    uint32_t level_mask = ~0u;     // 第 n 位对应 static_cast<int>(LogLevel)
+    uint64_t from = 0;
+    uint64_t to = ~static_cast<uint64_t>(0);
+
+    bool acceptsLevel(LogLevel level) const {
+        return (level_mask >> static_cast<int>(level)) & 1u;
+    }
+};
+
+// 只读映射一个二进制日志文件
+// open() 顺序扫描所有块头和格式字典，之后 decodeBlock() 可以在多个线程中并行调用
+class BinaryLogReader {
+public:
+    struct Block {
+        binlog::BlockHeader header;
+        const char* records;
+    };
+
+    BinaryLogReader() = default;
+    ~BinaryLogReader();
+
+    BinaryLogReader(const BinaryLogReader&) = delete;
+    BinaryLogReader& operator=(const BinaryLogReader&) = delete;
+
+    // 失败时返回 false 并设置 error()；文件尾部不完整的块会被忽略
+    bool open(const std::string& path);
+
+    const std::vector<Block>& blocks() const { return blocks_; }
+    const std::string& error() const { return error_; }
+
+    // 把一个块中满足条件的记录渲染为文本行（json 为 true 时为 JSON 行）追加到 out，返回输出的行数
+    size_t decodeBlock(const Block& block, const RecordFilter& filter,
+                       TimestampFormatter& formatter, std::string& out, bool json = false) const;
+
+private:
+    struct Format {
+        std::vector<ArgType> arg_types;      // 消息参数在前，字段在后
+        std::vector<std::string> segments;   // 消息参数个数 + 1 段字面文本
+        std::vector<std::string> fields;
+    };
+
+    // 渲染一条记录的消息和字段，payload 不完整时返回 false
+    static bool appendText(const Format& format, const char* payload, const char* end, std::string& out);
+    static bool appendJson(const Format& format, const char* payload, const char* end, std::string& out);
+
+    bool parseDictionary(const char* ptr, const char* end);
+    static const char* appendArg(ArgType type, const char* ptr, const char* end, std::string& out);
+
+    void* mapping_ = nullptr;
+    size_t size_ = 0;
+    std::vector<Format> formats_;
+    std::vector<Block> blocks_;
+    std::string error_;
+};
+
+#endif // BINARY_LOG_READER_H
@@ -0,0 +1,45 @@
+#ifndef BINARY_LOG_WRITER_H
+#define BINARY_LOG_WRITER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "log_record.h"
+#include "rotating_file.h"
+
+// 把记录按 binary_log_format.h 的格式编码成块，只在后台线程中使用
+// payload 直接拷贝调用方编码好的参数，不做任何格式化
+class BinaryLogWriter {
+public:
+    // nanos 为换算后的墙上时间（纳秒）
+    void append(const RecordHeader& header, uint64_t nanos, const char* payload);
+
+    size_t pendingBytes() const { return records_.size(); }
+    bool empty() const { return record_count_ == 0; }
+
+    // 写出当前块：必要时先轮转，新文件补写文件头和本块用到的字典条目
+    void writeBlock(RotatingFile& file);
+
+private:
+    uint32_t siteId(const CallSiteInfo* site);
+    void appendDictEntry(uint32_t id);
+
+    std::unordered_map<const CallSiteInfo*, uint32_t> ids_;
+    std::vector<const CallSiteInfo*> sites_;
+    std::vector<uint64_t> written_generation_;   // 每个 id 的字典条目写入了哪一代文件
+    std::vector<uint64_t> last_block_;           // 每个 id 最近一次被哪个块引用
+    std::vector<uint32_t> block_ids_;            // 当前块引用到的 id
+
+    std::string head_;
+    std::string dict_;
+    std::string records_;
+    uint64_t block_number_ = 1;
+    uint32_t record_count_ = 0;
+    uint64_t base_timestamp_ = 0;
+    uint64_t previous_timestamp_ = 0;
+    uint64_t min_timestamp_ = 0;
+    uint64_t max_timestamp_ = 0;
+};
+
+#endif // BINARY_LOG_WRITER_H
@@ -0,0 +1,44 @@
+#ifndef COMPRESSION_WORKER_H
+#define COMPRESSION_WORKER_H
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// 后台压缩轮转出来的日志段
+// 工作线程以最低优先级运行，线程数和待处理任务数都有上限，
+// 保证压缩不会和日志后台线程争抢 CPU
+class CompressionWorker {
+public:
+    CompressionWorker(int compression_level, size_t max_concurrency, size_t max_pending);
+    ~CompressionWorker();
+
+    CompressionWorker(const CompressionWorker&) = delete;
+    CompressionWorker& operator=(const CompressionWorker&) = delete;
+
+    // 提交一个待压缩的日志段，队列已满时返回 false，该段保持未压缩
+    bool submit(const std::string& segment_path);
+
+    // 是否编译了 zstd 支持
+    static bool isSupported();
+
+private:
+    void run();
+    bool compressSegment(const std::string& segment_path);
+    // 有索引的日志段：每个索引条目单独压缩成一帧，并生成指向各帧的 .zst.idx
+    bool compressIndexedSegment(const std::string& segment_path, const std::string& compressed_path);
+    static void lowerThreadPriority();
+
+    int compression_level_;
+    size_t max_pending_;
+    std::deque<std::string> pending_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable cond_var_;
+    bool is_shutdown_ = false;
+};
+
+#endif // COMPRESSION_WORKER_H
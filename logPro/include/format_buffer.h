@@ -0,0 +1,79 @@
+#ifndef FORMAT_BUFFER_H
+#define FORMAT_BUFFER_H
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// 固定容量的格式化缓冲区，放在栈上使用，超出容量的内容被截断，从不分配堆内存
+class FormatBuffer {
+public:
+    static constexpr size_t kCapacity = 512;
+
+    void append(const char* data, size_t size) {
+        if (size > kCapacity - size_) {
+            size = kCapacity - size_;
+            truncated_ = true;
+        }
+        std::memcpy(data_ + size_, data, size);
+        size_ += size;
+    }
+    void append(std::string_view text) { append(text.data(), text.size()); }
+    void push_back(char c) { append(&c, 1); }
+
+    std::string_view view() const { return std::string_view(data_, size_); }
+    operator std::string_view() const { return view(); }
+    size_t size() const { return size_; }
+    bool truncated() const { return truncated_; }
+    void clear() {
+        size_ = 0;
+        truncated_ = false;
+    }
+
+private:
+    char data_[kCapacity];
+    size_t size_ = 0;
+    bool truncated_ = false;
+};
+
+// 把算术值或指针追加到 out（std::string 或 FormatBuffer）末尾
+// 整数和浮点数用 std::to_chars，浮点数输出可精确还原的最短形式
+template<typename Out, typename T>
+void appendValue(Out& out, T value) {
+    if constexpr (std::is_same<T, bool>::value) {
+        out.push_back(value ? '1' : '0');
+    } else if constexpr (std::is_same<T, char>::value || std::is_same<T, signed char>::value ||
+                         std::is_same<T, unsigned char>::value) {
+        out.push_back(static_cast<char>(value));
+    } else if constexpr (std::is_pointer<T>::value) {
+        char digits[2 + 2 * sizeof(void*)] = {'0', 'x'};
+        auto result = std::to_chars(digits + 2, digits + sizeof(digits),
+                                    reinterpret_cast<uintptr_t>(value), 16);
+        out.append(digits, static_cast<size_t>(result.ptr - digits));
+    } else {
+        static_assert(std::is_arithmetic<T>::value, "appendValue requires an arithmetic or pointer type");
+        char digits[64];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, static_cast<size_t>(result.ptr - digits));
+    }
+}
+
+// 用户类型的格式化扩展点：
+//   template<> struct LogFormatter<Point> {
+//       static void format(const Point& p, FormatBuffer& out) { ... }
+//   };
+// 有特化的类型在调用方线程格式化进栈上的 FormatBuffer，不分配内存；
+// 没有特化的类型退回 operator<<
+template<typename T>
+struct LogFormatter {};
+
+template<typename T>
+concept HasLogFormatter = requires(const T& value, FormatBuffer& out) {
+    LogFormatter<T>::format(value, out);
+};
+
+#endif // FORMAT_BUFFER_H
@@ -0,0 +1,64 @@
+#ifndef FORMAT_STRING_H
+#define FORMAT_STRING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 可作为模板参数的字符串字面量，log<"...">() 的格式串在编译期解析
+template<size_t N>
+struct FixedString {
+    char data[N]{};
+
+    constexpr FixedString(const char (&str)[N]) {
+        for (size_t i = 0; i < N; ++i) {
+            data[i] = str[i];
+        }
+    }
+
+    constexpr size_t size() const { return N - 1; }
+};
+
+// 格式串中两个占位符之间的一段字面文本
+struct FormatSegment {
+    uint32_t offset;
+    uint32_t length;
+};
+
+// 占位符把格式串切成 placeholders + 1 段，第 i 段之后紧跟第 i 个参数
+template<size_t Placeholders>
+struct FormatSpec {
+    FormatSegment segments[Placeholders + 1];
+};
+
+template<size_t N>
+constexpr size_t countPlaceholders(const FixedString<N>& fmt) {
+    size_t count = 0;
+    for (size_t i = 0; i + 1 < fmt.size(); ++i) {
+        if (fmt.data[i] == '{' && fmt.data[i + 1] == '}') {
+            ++count;
+            ++i;
+        }
+    }
+    return count;
+}
+
+template<auto Fmt>
+constexpr auto parseFormat() {
+    FormatSpec<countPlaceholders(Fmt)> spec{};
+    size_t segment = 0;
+    size_t start = 0;
+    for (size_t i = 0; i + 1 < Fmt.size(); ++i) {
+        if (Fmt.data[i] == '{' && Fmt.data[i + 1] == '}') {
+            spec.segments[segment++] = FormatSegment{static_cast<uint32_t>(start),
+                                                     static_cast<uint32_t>(i - start)};
+            start = i + 2;
+            ++i;
+        }
+    }
+    spec.segments[segment] = FormatSegment{static_cast<uint32_t>(start),
+                                           static_cast<uint32_t>(Fmt.size() - start)};
+    return spec;
+}
+
+#endif // FORMAT_STRING_H
@@ -0,0 +1,113 @@
+#ifndef LOG_CLOCK_H
+#define LOG_CLOCK_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// 调用方线程读取时间戳的方式
+enum class ClockSource {
+    System,   // system_clock，纳秒
+    Tsc       // CPU 时间戳计数器，后台线程按校准结果换算成纳秒
+};
+
+// 日志中时间戳小数部分的位数
+enum class TimestampPrecision {
+    Micro,    // 2026-01-01 12:00:00.123456
+    Nano      // 2026-01-01 12:00:00.123456789
+};
+
+// 调用方线程只调用 now()，换算都在后台线程
+//
+// Tsc 模式下换算用的 (基准计数, 基准纳秒, 每计数纳秒) 由后台线程通过 recalibrate()
+// 约每秒重新对齐 system_clock 一次：基准跟随 NTP 和墙上时间的调整，速率按从构造起不断增长的
+// 窗口重新估计，不会因为启动时 10ms 的测量误差累积漂移。三个值用 seqlock 发布，toNanos() 不会读到一半
+class LogClock {
+public:
+    explicit LogClock(ClockSource source = ClockSource::System);
+
+    LogClock(const LogClock&) = delete;
+    LogClock& operator=(const LogClock&) = delete;
+
+    uint64_t now() const {
+        return source_ == ClockSource::Tsc ? readTsc() : systemNanos();
+    }
+
+    // 把 now() 的返回值换算成自 epoch 起的纳秒
+    uint64_t toNanos(uint64_t ticks) const;
+
+    // 后台线程每轮调用，距上次对齐不到 kRecalibrationInterval 时直接返回；
+    // 多个后台线程同时调用时只有一个执行
+    void recalibrate();
+
+    // 两次 now() 之间的纳秒数，时钟回拨时为 0
+    uint64_t elapsedNanos(uint64_t from, uint64_t to) const {
+        if (to <= from) {
+            return 0;
+        }
+        return source_ == ClockSource::Tsc
+            ? static_cast<uint64_t>(static_cast<double>(to - from) * nanos_per_tick_.load(std::memory_order_relaxed))
+            : to - from;
+    }
+
+    ClockSource source() const { return source_; }
+
+    static bool tscSupported();
+
+    static uint64_t readTsc() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t value;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+        return value;
+#else
+        return systemNanos();
+#endif
+    }
+
+    static uint64_t systemNanos() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    static constexpr auto kRecalibrationInterval = std::chrono::seconds(1);
+
+private:
+    // 同时读取计数和 system_clock，计数取前后两次读数的中点
+    static void sample(uint64_t& ticks, uint64_t& nanos);
+
+    ClockSource source_;
+    // seqlock：写者先把序号改为奇数，写完再改回偶数
+    std::atomic<uint32_t> sequence_{0};
+    std::atomic<uint64_t> base_ticks_{0};
+    std::atomic<uint64_t> base_nanos_{0};
+    std::atomic<double> nanos_per_tick_{1.0};
+
+    uint64_t origin_ticks_ = 0;     // 估计速率的窗口起点
+    uint64_t origin_nanos_ = 0;
+    std::atomic<uint64_t> next_recalibration_{0};   // 计数值，到达后才重新对齐
+    std::atomic<bool> recalibrating_{false};
+};
+
+// 后台线程使用：按秒缓存 "YYYY-mm-dd HH:MM:SS" 前缀，每条日志只改写小数部分
+class TimestampFormatter {
+public:
+    explicit TimestampFormatter(TimestampPrecision precision = TimestampPrecision::Micro)
+        : precision_(precision) {}
+
+    void append(uint64_t nanos, std::string& out);
+
+private:
+    TimestampPrecision precision_;
+    int64_t cached_second_ = -1;
+    char prefix_[32];
+    size_t prefix_length_ = 0;
+};
+
+#endif // LOG_CLOCK_H
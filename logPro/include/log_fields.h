@@ -0,0 +1,62 @@
+#ifndef LOG_FIELDS_H
+#define LOG_FIELDS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include "format_string.h"
+
+// 结构化字段：log<"order placed">(LogLevel::INFO, kv<"order_id">(id), kv<"amount">(amount))
+// 字段跟在消息参数之后，键是编译期常量，只存放在调用点描述中，记录里只编码值。
+// 文本格式输出为消息后的 key=value，LogFormat::Json 输出为同一个 JSON 对象中的键值对，
+// 二进制格式在格式字典中记录键名，logdecode --json 可以直接还原成 JSON 行
+
+template<FixedString Key, typename V>
+struct Field {
+    static constexpr auto key = Key;
+    V value;    // kv() 得到的是调用方参数的引用，不拷贝
+};
+
+// 键只允许字母、数字、下划线、点和连字符，输出时不需要转义
+template<size_t N>
+constexpr bool isValidFieldKey(const FixedString<N>& key) {
+    if (key.size() == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < key.size(); ++i) {
+        const char c = key.data[i];
+        const bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                           c == '_' || c == '.' || c == '-';
+        if (!valid) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<FixedString Key, typename T>
+Field<Key, const T&> kv(const T& value) {
+    static_assert(isValidFieldKey(Key), "field keys may only contain [A-Za-z0-9_.-]");
+    return Field<Key, const T&>{value};
+}
+
+template<typename T>
+struct IsField : std::false_type {};
+
+template<FixedString Key, typename V>
+struct IsField<Field<Key, V>> : std::true_type {};
+
+// ---- 后台线程的渲染辅助，参数已经按文本解码到 out[start..] ----
+
+enum class ArgType : uint8_t;
+
+// 把 out[start..] 原地转义为 JSON 字符串内容，没有需要转义的字符时不做任何改动
+void escapeJson(std::string& out, size_t start);
+// 把 out[start..] 改写为 JSON 值：字符串、字符和指针加引号，bool 改为 true/false，
+// NaN/Inf 加引号（JSON 没有这些数值）
+void finishJsonValue(ArgType type, std::string& out, size_t start);
+// 文本日志中 key=value 的值：空字符串或含空格、引号、等号的字符串按 JSON 规则加引号
+void finishTextValue(ArgType type, std::string& out, size_t start);
+
+#endif // LOG_FIELDS_H
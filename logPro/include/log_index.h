@@ -0,0 +1,117 @@
+#ifndef LOG_INDEX_H
+#define LOG_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "log_record.h"
+
+// 文本日志的稀疏时间索引 <日志文件>.idx
+//
+//   文件 = IndexFileHeader IndexEntry*
+//
+// 后台线程每写出约 index_interval 字节追加一条 IndexEntry，记录这段数据在日志文件中的
+// 位置、时间范围和出现过的级别。轮转时索引随日志段一起改名；压缩时每个条目对应的数据
+// 单独压缩成一个 zstd 帧，生成 <段>.zst 和 <段>.zst.idx，条目的位置改为帧在 .zst 中的位置。
+// 多个帧直接拼接仍是合法的 zstd 文件，可以用 zstd -d 整体解压。
+namespace logindex {
+
+constexpr char kFileMagic[4] = {'L', 'P', 'I', 'X'};
+constexpr uint32_t kFileVersion = 1;
+constexpr uint32_t kCompressedFrames = 1;   // 条目位置指向 zstd 帧
+
+struct IndexFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t reserved;
+};
+
+struct IndexEntry {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t min_timestamp;     // 自 epoch 起的纳秒
+    uint64_t max_timestamp;
+    uint32_t level_mask;        // 第 n 位对应 static_cast<int>(LogLevel)
+    uint32_t reserved;
+};
+
+inline std::string indexPath(const std::string& log_path) {
+    return log_path + ".idx";
+}
+
+// 读取整个索引文件，文件不存在或格式不对时返回 false；末尾不完整的条目被忽略
+bool readIndexFile(const std::string& path, uint32_t& flags, std::vector<IndexEntry>& entries);
+// 写出完整的索引文件（压缩日志段时使用）
+bool writeIndexFile(const std::string& path, uint32_t flags, const std::vector<IndexEntry>& entries);
+
+} // namespace logindex
+
+// 一段日志数据的时间范围和出现过的级别，后台线程逐条累计
+struct IndexRange {
+    uint64_t min_timestamp = ~static_cast<uint64_t>(0);
+    uint64_t max_timestamp = 0;
+    uint32_t level_mask = 0;
+
+    bool empty() const { return level_mask == 0; }
+
+    void add(uint64_t nanos, LogLevel level) {
+        min_timestamp = nanos < min_timestamp ? nanos : min_timestamp;
+        max_timestamp = nanos > max_timestamp ? nanos : max_timestamp;
+        level_mask |= 1u << static_cast<int>(level);
+    }
+
+    void merge(const IndexRange& other) {
+        min_timestamp = other.min_timestamp < min_timestamp ? other.min_timestamp : min_timestamp;
+        max_timestamp = other.max_timestamp > max_timestamp ? other.max_timestamp : max_timestamp;
+        level_mask |= other.level_mask;
+    }
+};
+
+// 按索引读取一个文本日志段（未压缩或按帧压缩的 .zst）
+// 没有被索引覆盖的部分（没有索引文件、进程崩溃前最后一段）作为时间范围未知的块，总是需要读取
+class IndexedLogReader {
+public:
+    struct Chunk {
+        uint64_t offset;
+        uint64_t size;
+        IndexRange range;
+        bool indexed;
+    };
+
+    IndexedLogReader() = default;
+    ~IndexedLogReader();
+
+    IndexedLogReader(const IndexedLogReader&) = delete;
+    IndexedLogReader& operator=(const IndexedLogReader&) = delete;
+
+    // 失败时返回 false 并设置 error()
+    bool open(const std::string& path);
+
+    const std::vector<Chunk>& chunks() const { return chunks_; }
+    const std::string& error() const { return error_; }
+    bool compressed() const { return compressed_; }
+    // 已索引部分最早的时间戳，没有索引时为 0
+    uint64_t firstTimestamp() const;
+
+    // 返回可能包含 [from, to] 内、级别在 level_mask 中的记录的块下标，按文件顺序排列。
+    // 先按前缀最大时间戳二分查找起点，遇到后缀最小时间戳超过 to 的块即停止
+    std::vector<size_t> select(uint64_t from, uint64_t to, uint32_t level_mask) const;
+
+    // 取出一个块的文本：未压缩时直接指向映射区，压缩时解压到 buffer
+    bool read(const Chunk& chunk, std::string& buffer, std::string_view& text) const;
+
+private:
+    void buildChunks(const std::vector<logindex::IndexEntry>& entries);
+
+    void* mapping_ = nullptr;
+    size_t size_ = 0;
+    bool compressed_ = false;
+    std::vector<Chunk> chunks_;
+    std::vector<uint64_t> prefix_max_;   // 已索引块的前缀最大时间戳
+    std::vector<uint64_t> suffix_min_;   // 已索引块的后缀最小时间戳
+    std::string error_;
+};
+
+#endif // LOG_INDEX_H
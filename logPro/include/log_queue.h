@@ -0,0 +1,129 @@
+#ifndef LOG_QUEUE_H
+#define LOG_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include "mpmc_ring.h"
+#include "overflow_policy.h"
+#include "spin_wait.h"
+#include "log_record.h"
+
+// 多生产者/单消费者日志队列
+// 生产者无锁写入预分配的环形槽位；消费者先自旋再休眠，
+// 只有消费者已休眠时生产者才需要发信号，不再每条消息 notify 一次。
+// 队列容量固定，写满时按 OverflowPolicy 等待或丢弃，丢弃数计入 drops
+class LogQueue {
+public:
+    explicit LogQueue(size_t capacity = 65536, const OverflowOptions& overflow = OverflowOptions(),
+                      DropCounter* drops = nullptr)
+        : ring_(capacity)
+        , overflow_(overflow)
+        , drops_(drops) {}
+
+    // 返回 false 表示新记录被丢弃
+    bool push(LogRecord msg) {
+        if (!ring_.tryPush(std::move(msg)) && !pushFull(msg)) {
+            return false;
+        }
+        parker_.notify();
+        return true;
+    }
+
+    bool pop(LogRecord& msg) {
+        SpinWait spin;
+        for (;;) {
+            if (ring_.tryPop(msg)) {
+                return true;
+            }
+            if (is_shutdown_.load(std::memory_order_acquire)) {
+                // shutdown 之后再取一次，避免丢掉最后发布的消息
+                return ring_.tryPop(msg);
+            }
+            if (!spin.spinOnce()) {
+                parker_.park([this]() {
+                    return !ring_.empty() || is_shutdown_.load(std::memory_order_acquire);
+                }, std::chrono::milliseconds(100));
+                spin.reset();
+            }
+        }
+    }
+
+    // 非阻塞取出一条，后台线程批量取数据时使用
+    bool tryPop(LogRecord& msg) {
+        return ring_.tryPop(msg);
+    }
+
+    // 等到有数据、shutdown 或超时；先自旋再休眠
+    void wait(std::chrono::milliseconds max_wait) {
+        SpinWait spin;
+        while (ring_.empty() && !is_shutdown_.load(std::memory_order_acquire)) {
+            if (!spin.spinOnce()) {
+                parker_.park([this]() {
+                    return !ring_.empty() || is_shutdown_.load(std::memory_order_acquire);
+                }, max_wait);
+                return;
+            }
+        }
+    }
+
+    // 当前积压的记录数（近似），用于指标
+    size_t size() const {
+        return ring_.size();
+    }
+
+    void shutdown() {
+        is_shutdown_.store(true, std::memory_order_release);
+        parker_.wakeAll();
+    }
+
+private:
+    // tryPush 失败时 msg 保持原样，按策略重试或丢弃
+    bool pushFull(LogRecord& msg) {
+        const LogLevel level = msg.header.level;
+        switch (overflow_.policy) {
+            case OverflowPolicy::DropNewest:
+                countDrop(level);
+                return false;
+            case OverflowPolicy::DropOldest: {
+                LogRecord evicted;
+                while (!ring_.tryPush(std::move(msg))) {
+                    if (ring_.tryPop(evicted)) {
+                        countDrop(evicted.header.level);
+                    }
+                }
+                return true;
+            }
+            case OverflowPolicy::DropBelowLevel:
+                if (static_cast<int>(level) < static_cast<int>(overflow_.min_level)) {
+                    countDrop(level);
+                    return false;
+                }
+                break;
+            case OverflowPolicy::Block:
+                break;
+        }
+
+        OverflowBackoff backoff(overflow_.block_timeout);
+        while (!ring_.tryPush(std::move(msg))) {
+            if (!backoff.wait()) {
+                countDrop(level);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void countDrop(LogLevel level) {
+        if (drops_ != nullptr) {
+            drops_->add(level);
+        }
+    }
+
+    MpmcRing<LogRecord> ring_;
+    const OverflowOptions overflow_;
+    DropCounter* drops_;
+    ConsumerParker parker_;
+    std::atomic<bool> is_shutdown_{false};
+};
+
+#endif // LOG_QUEUE_H
@@ -0,0 +1,354 @@
+#ifndef LOG_RECORD_H
+#define LOG_RECORD_H
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include "format_buffer.h"
+#include "format_string.h"
+#include "log_fields.h"
+#include "record_buffer_pool.h"
+
+// 没有 LogFormatter 特化的用户类型的退路，每次调用都会分配内存
+template<typename T>
+std::string to_string_helper(T&& arg) {
+    std::ostringstream oss;
+    oss << std::forward<T>(arg);
+    return oss.str();
+}
+
+// 按严重程度从低到高排列，级别过滤直接比较数值
+enum class LogLevel {
+    DEBUG,
+    INFO,
+    WARN,
+    ERROR
+};
+
+constexpr size_t kLogLevelCount = 4;
+
+inline const char* levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG:
+            return "DEBUG";
+        case LogLevel::INFO:
+            return "INFO";
+        case LogLevel::WARN:
+            return "WARN";
+        case LogLevel::ERROR:
+            return "ERROR";
+    }
+    return "";
+}
+
+// 按名称解析日志级别，供离线工具使用
+inline bool parseLevel(std::string_view name, LogLevel& level) {
+    for (LogLevel candidate : {LogLevel::DEBUG, LogLevel::INFO, LogLevel::WARN, LogLevel::ERROR}) {
+        if (name == levelName(candidate)) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline const char* levelTag(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG:
+            return "[DEBUG] ";
+        case LogLevel::INFO:
+            return "[INFO] ";
+        case LogLevel::WARN:
+            return "[WARN] ";
+        case LogLevel::ERROR:
+            return "[ERROR] ";
+    }
+    return "";
+}
+
+// 参数在 payload 中的类型编码，写入二进制日志的格式字典供离线解码
+enum class ArgType : uint8_t {
+    None = 0,
+    Bool,
+    Char,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Int64,
+    UInt64,
+    Float,
+    Double,
+    LongDouble,
+    Pointer,
+    String
+};
+
+template<typename T>
+constexpr ArgType argTypeOf() {
+    if constexpr (std::is_same<T, bool>::value) {
+        return ArgType::Bool;
+    } else if constexpr (std::is_same<T, char>::value || std::is_same<T, signed char>::value ||
+                         std::is_same<T, unsigned char>::value) {
+        return ArgType::Char;
+    } else if constexpr (std::is_integral<T>::value) {
+        constexpr bool is_signed = std::is_signed<T>::value;
+        if constexpr (sizeof(T) == 2) {
+            return is_signed ? ArgType::Int16 : ArgType::UInt16;
+        } else if constexpr (sizeof(T) == 4) {
+            return is_signed ? ArgType::Int32 : ArgType::UInt32;
+        } else {
+            static_assert(sizeof(T) == 8, "unsupported integer size");
+            return is_signed ? ArgType::Int64 : ArgType::UInt64;
+        }
+    } else if constexpr (std::is_same<T, float>::value) {
+        return ArgType::Float;
+    } else if constexpr (std::is_same<T, double>::value) {
+        return ArgType::Double;
+    } else if constexpr (std::is_same<T, long double>::value) {
+        return ArgType::LongDouble;
+    } else {
+        static_assert(std::is_pointer<T>::value, "unsupported log argument type");
+        return ArgType::Pointer;
+    }
+}
+
+// 后台线程用来把 payload 还原成文本的函数，每个调用点实例化一个
+using FormatFn = void (*)(const char* payload, std::string& out);
+
+// 调用点描述，静态存储期，记录中只保存它的地址
+struct CallSiteInfo {
+    const char* format;
+    const FormatSegment* segments;
+    size_t segment_count;
+    FormatFn format_fn;
+    const ArgType* arg_types;       // segment_count - 1 个消息参数加 field_count 个字段的类型
+    FormatFn json_fn;               // 渲染 "msg":"...",字段...（不含外层花括号）
+    const char* const* field_names;
+    size_t field_count;
+};
+
+// 一条二进制日志记录的头部，调用方只填写原始参数，格式化全部在后台线程完成
+struct RecordHeader {
+    uint64_t timestamp;      // LogClock::now() 的读数
+    const CallSiteInfo* site;
+    uint32_t payload_size;   // 紧跟在头部之后的参数字节数
+    LogLevel level;
+};
+
+// Shared 模式下在环形队列中传递的记录，只能移动；参数放在池化的缓冲区里
+struct LogRecord {
+    RecordHeader header;
+    PooledBuffer payload;
+};
+
+// ---- 参数编码 ----
+// 算术类型和指针按值拷贝；字符串拷贝内容（4 字节长度 + 字节）；
+// 其他类型在调用方线程用 operator<< 转成字符串后按字符串编码
+
+template<typename T>
+struct ArgTraits {
+    static_assert(std::is_arithmetic<T>::value || std::is_pointer<T>::value,
+                  "unsupported log argument type");
+
+    static constexpr ArgType type = argTypeOf<T>();
+
+    static size_t size(const T&) { return sizeof(T); }
+
+    static char* encode(char* dst, const T& value) {
+        std::memcpy(dst, &value, sizeof(T));
+        return dst + sizeof(T);
+    }
+
+    static const char* decode(const char* src, std::string& out) {
+        T value;
+        std::memcpy(&value, src, sizeof(T));
+        appendValue(out, value);
+        return src + sizeof(T);
+    }
+};
+
+struct StringArgTraits {
+    static constexpr ArgType type = ArgType::String;
+
+    static size_t size(std::string_view value) { return sizeof(uint32_t) + value.size(); }
+
+    static char* encode(char* dst, std::string_view value) {
+        uint32_t length = static_cast<uint32_t>(value.size());
+        std::memcpy(dst, &length, sizeof(length));
+        std::memcpy(dst + sizeof(length), value.data(), length);
+        return dst + sizeof(length) + length;
+    }
+
+    static const char* decode(const char* src, std::string& out) {
+        uint32_t length;
+        std::memcpy(&length, src, sizeof(length));
+        out.append(src + sizeof(length), length);
+        return src + sizeof(length) + length;
+    }
+};
+
+template<> struct ArgTraits<std::string> : StringArgTraits {};
+template<> struct ArgTraits<std::string_view> : StringArgTraits {};
+template<> struct ArgTraits<const char*> : StringArgTraits {};
+template<> struct ArgTraits<FormatBuffer> : StringArgTraits {};
+
+// 参数在记录中的存储类型：字符数组和 char* 统一按 const char* 处理
+template<typename T>
+using StoredArg = std::conditional_t<std::is_same<std::decay_t<T>, char*>::value,
+                                     const char*, std::decay_t<T>>;
+
+template<typename T>
+struct IsNativeArg
+    : std::integral_constant<bool, std::is_arithmetic<T>::value || std::is_pointer<T>::value ||
+                                   std::is_same<T, std::string>::value ||
+                                   std::is_same<T, std::string_view>::value> {};
+
+// 字段只编码值，键在调用点描述中
+template<FixedString Key, typename V>
+struct ArgTraits<Field<Key, V>> : ArgTraits<StoredArg<V>> {
+    using Value = ArgTraits<StoredArg<V>>;
+
+    static size_t size(const Field<Key, V>& field) { return Value::size(field.value); }
+    static char* encode(char* dst, const Field<Key, V>& field) { return Value::encode(dst, field.value); }
+};
+
+// 可直接编码的参数原样返回引用；有 LogFormatter 特化的类型格式化进栈上的 FormatBuffer；
+// 其余类型用 operator<< 转成字符串。字段按同样规则处理其中的值
+template<typename T>
+decltype(auto) prepareArg(const T& arg) {
+    if constexpr (IsField<T>::value) {
+        if constexpr (IsNativeArg<std::decay_t<decltype(arg.value)>>::value) {
+            return (arg);
+        } else {
+            using Prepared = std::decay_t<decltype(prepareArg(arg.value))>;
+            return Field<T::key, Prepared>{prepareArg(arg.value)};
+        }
+    } else if constexpr (IsNativeArg<std::decay_t<T>>::value) {
+        return (arg);
+    } else if constexpr (HasLogFormatter<std::decay_t<T>>) {
+        FormatBuffer buffer;
+        LogFormatter<std::decay_t<T>>::format(arg, buffer);
+        return buffer;
+    } else {
+        return to_string_helper(arg);
+    }
+}
+
+template<typename... Args>
+struct ArgCodec {
+    static size_t size(const Args&... args) {
+        return (size_t(0) + ... + ArgTraits<Args>::size(args));
+    }
+
+    static char* encode(char* dst, const Args&... args) {
+        ((dst = ArgTraits<Args>::encode(dst, args)), ...);
+        return dst;
+    }
+};
+
+// 字段必须全部跟在消息参数之后
+template<typename... Args>
+constexpr bool fieldsTrailing() {
+    bool seen_field = false;
+    bool ordered = true;
+    ((ordered = ordered && (IsField<Args>::value || !seen_field), seen_field = seen_field || IsField<Args>::value), ...);
+    return ordered;
+}
+
+template<typename A>
+constexpr const char* fieldKey() {
+    if constexpr (IsField<A>::value) {
+        return A::key.data;
+    } else {
+        return nullptr;
+    }
+}
+
+// 每个 log<"...">() 调用点（格式串 + 参数类型列表）实例化一次：
+// 编译期解析出字面文本段并检查占位符个数，后台线程按段表直接拼接，不再扫描格式串
+template<FixedString Fmt, typename... Args>
+struct CallSite {
+    static constexpr size_t field_count = (size_t(0) + ... + (IsField<Args>::value ? 1 : 0));
+    static constexpr size_t message_args = sizeof...(Args) - field_count;
+    static constexpr auto spec = parseFormat<Fmt>();
+    static_assert(fieldsTrailing<Args...>(), "kv<...>() fields must follow the message arguments");
+    static_assert(countPlaceholders(Fmt) == message_args,
+                  "log format string placeholder count does not match the number of arguments");
+
+    // 消息文本，字段以 key=value 追加在后面
+    static void format(const char* payload, std::string& out) {
+        out.append(Fmt.data + spec.segments[0].offset, spec.segments[0].length);
+        size_t index = 1;
+        ((payload = appendText<Args>(payload, out, index)), ...);
+        (void)payload;
+        (void)index;
+    }
+
+    // "msg":"消息文本","key":value,...
+    static void json(const char* payload, std::string& out) {
+        out += "\"msg\":\"";
+        size_t message_start = out.size();
+        out.append(Fmt.data + spec.segments[0].offset, spec.segments[0].length);
+        size_t index = 1;
+        ((payload = appendJson<Args>(payload, out, index, message_start)), ...);
+        (void)payload;
+        (void)index;
+        if (message_start != std::string::npos) {
+            escapeJson(out, message_start);
+            out += '"';
+        }
+    }
+
+    static constexpr ArgType arg_types[sizeof...(Args) + 1] = {ArgTraits<Args>::type..., ArgType::None};
+    static constexpr const char* keys[sizeof...(Args) + 1] = {fieldKey<Args>()..., nullptr};
+    static constexpr CallSiteInfo info{Fmt.data, spec.segments, message_args + 1, &format, arg_types,
+                                       &json, keys + message_args, field_count};
+
+private:
+    template<typename A>
+    static const char* appendText(const char* payload, std::string& out, size_t& index) {
+        if constexpr (IsField<A>::value) {
+            out += ' ';
+            out.append(A::key.data, A::key.size());
+            out += '=';
+            const size_t start = out.size();
+            payload = ArgTraits<A>::decode(payload, out);
+            finishTextValue(ArgTraits<A>::type, out, start);
+        } else {
+            payload = ArgTraits<A>::decode(payload, out);
+            out.append(Fmt.data + spec.segments[index].offset, spec.segments[index].length);
+            ++index;
+        }
+        return payload;
+    }
+
+    // message_start 在消息结束（遇到第一个字段）后置为 npos
+    template<typename A>
+    static const char* appendJson(const char* payload, std::string& out, size_t& index, size_t& message_start) {
+        if constexpr (IsField<A>::value) {
+            if (message_start != std::string::npos) {
+                escapeJson(out, message_start);
+                out += '"';
+                message_start = std::string::npos;
+            }
+            out += ",\"";
+            out.append(A::key.data, A::key.size());
+            out += "\":";
+            const size_t start = out.size();
+            payload = ArgTraits<A>::decode(payload, out);
+            finishJsonValue(ArgTraits<A>::type, out, start);
+        } else {
+            payload = ArgTraits<A>::decode(payload, out);
+            out.append(Fmt.data + spec.segments[index].offset, spec.segments[index].length);
+            ++index;
+        }
+        return payload;
+    }
+};
+
+#endif // LOG_RECORD_H
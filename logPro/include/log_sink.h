@@ -0,0 +1,126 @@
+#ifndef LOG_SINK_H
+#define LOG_SINK_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "log_record.h"
+#include "rotating_file.h"
+
+// 后台线程一轮渲染好的文本行，所有输出目标共享同一份只读数据
+struct LogBatch {
+    struct Line {
+        uint64_t nanos;     // 记录的时间戳（自 epoch 起的纳秒）
+        uint32_t offset;
+        uint32_t length;    // 含结尾的 '\n'
+        LogLevel level;
+    };
+
+    std::string text;
+    std::vector<Line> lines;
+    LogLevel max_level = LogLevel::DEBUG;
+
+    bool empty() const { return lines.empty(); }
+
+    void clear() {
+        text.clear();
+        lines.clear();
+        max_level = LogLevel::DEBUG;
+    }
+};
+
+// 输出目标基类
+// 每个输出目标有自己的级别阈值，Logger 为它单独开一个线程和有界批次队列，
+// 慢的控制台或网络目标积压时只丢弃自己的批次，不影响主日志文件和调用方
+class LogSink {
+public:
+    explicit LogSink(LogLevel level = LogLevel::DEBUG, size_t max_pending_batches = 64)
+        : level_(level)
+        , max_pending_batches_(max_pending_batches == 0 ? 1 : max_pending_batches) {}
+    virtual ~LogSink() = default;
+
+    LogSink(const LogSink&) = delete;
+    LogSink& operator=(const LogSink&) = delete;
+
+    void setLevel(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+    LogLevel level() const { return level_.load(std::memory_order_relaxed); }
+    bool accepts(LogLevel level) const {
+        return static_cast<int>(level) >= static_cast<int>(this->level());
+    }
+
+    size_t maxPendingBatches() const { return max_pending_batches_; }
+    // 因积压被丢弃的行数
+    uint64_t droppedLines() const { return dropped_lines_.load(std::memory_order_relaxed); }
+    void addDropped(uint64_t lines) { dropped_lines_.fetch_add(lines, std::memory_order_relaxed); }
+
+    // 按级别过滤后把连续的行交给 writeText()，只在该目标自己的线程中调用
+    void write(const LogBatch& batch);
+    // 队列取空时调用
+    virtual void flush() {}
+
+protected:
+    // text 由一行或多行完整的日志组成
+    virtual void writeText(std::string_view text) = 0;
+
+private:
+    std::atomic<LogLevel> level_;
+    const size_t max_pending_batches_;
+    std::atomic<uint64_t> dropped_lines_{0};
+};
+
+// 标准输出/标准错误
+class ConsoleSink : public LogSink {
+public:
+    explicit ConsoleSink(LogLevel level = LogLevel::DEBUG, bool use_stderr = false)
+        : LogSink(level)
+        , stream_(use_stderr ? stderr : stdout) {}
+
+    void flush() override;
+
+protected:
+    void writeText(std::string_view text) override;
+
+private:
+    FILE* stream_;
+};
+
+// 额外的轮转文件，例如只收 ERROR 的错误日志
+class FileSink : public LogSink {
+public:
+    FileSink(const std::string& filename, const RotationPolicy& policy = RotationPolicy(),
+             LogLevel level = LogLevel::DEBUG)
+        : LogSink(level)
+        , file_(filename, policy) {}
+
+protected:
+    void writeText(std::string_view text) override;
+
+private:
+    RotatingFile file_;
+};
+
+// 内存环形缓冲区，只保留最近 capacity 字节的日志，供崩溃时转储
+class MemoryRingSink : public LogSink {
+public:
+    explicit MemoryRingSink(size_t capacity = 1024 * 1024, LogLevel level = LogLevel::DEBUG);
+
+    // 从最早的完整行开始返回缓冲区内容
+    std::string snapshot() const;
+    // 不加锁、不分配内存地把缓冲区写到 fd，可在信号处理函数中调用；
+    // 最旧的一行可能不完整
+    void dump(int fd) const;
+
+protected:
+    void writeText(std::string_view text) override;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<char> buffer_;
+    size_t head_ = 0;       // 下一次写入的位置
+    bool wrapped_ = false;
+};
+
+#endif // LOG_SINK_H
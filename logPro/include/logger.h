@@ -0,0 +1,399 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include "log_record.h"
+#include "log_queue.h"
+#include "logger_metrics.h"
+#include "overflow_policy.h"
+#include "rate_limiter.h"
+#include "rotating_file.h"
+#include "thread_staging.h"
+#include "log_clock.h"
+#include "binary_log_writer.h"
+#include "log_sink.h"
+#include "sink_channel.h"
+#include "shm_log_ring.h"
+
+// 生产者到后台线程的传递方式
+enum class QueueMode {
+    Shared,     // 所有线程共用一个无锁 MPSC 环形队列
+    PerThread   // 每个线程一个 SPSC 字节环，后台线程轮询并按时间戳归并
+};
+
+// 后台线程把批量缓冲写入文件的时机
+enum class FlushPolicy {
+    PerBatch,       // 每取空一轮队列写出一次
+    Periodic,       // 缓冲区写满或距上次写出超过 flush_interval 时写出
+    FsyncOnError    // 同 PerBatch，批次中有 ERROR 日志时写出后再 fdatasync
+};
+
+// 日志文件格式
+enum class LogFormat {
+    Text,     // 每行一条文本日志，kv<>() 字段以 key=value 跟在消息后
+    Binary,   // 格式字典 + 打包参数，用 logdecode 还原成文本或 JSON
+    Json      // 每行一个 JSON 对象：ts、level、msg 和各字段
+};
+
+struct LoggerOptions {
+    LogLevel level = LogLevel::DEBUG;           // 运行时级别阈值，可用 setLevel() 修改
+    QueueMode queue_mode = QueueMode::Shared;
+    size_t backend_threads = 1;                 // 后台线程（分片）个数，大于 1 时每个分片写自己的文件
+    size_t queue_capacity = 65536;              // Shared：每个分片的环形队列槽位数
+    size_t record_buffer_size = 256;            // Shared：池化参数缓冲区的大小，更大的记录单独分配
+    size_t record_pool_size = 8192;             // Shared：每个分片的池化参数缓冲区个数
+    size_t staging_buffer_size = 512 * 1024;    // PerThread：每个线程的字节环大小
+    OverflowOptions overflow;                   // 队列写满时等待还是丢弃
+    LogFormat format = LogFormat::Text;
+    bool console_output = true;                 // 追加一个输出到标准输出的 ConsoleSink
+    std::vector<std::shared_ptr<LogSink>> sinks;    // 主日志文件之外的输出目标，各自一个线程
+    FlushPolicy flush_policy = FlushPolicy::PerBatch;
+    std::chrono::milliseconds flush_interval{100};  // Periodic：最长缓冲时间
+    size_t write_buffer_size = 1024 * 1024;     // 批量缓冲达到该大小时立即写出
+    ClockSource clock_source = ClockSource::System;
+    TimestampPrecision timestamp_precision = TimestampPrecision::Micro;
+    RotationPolicy rotation;
+    FileWriteMode file_write_mode = FileWriteMode::Write;   // Mmap：写入只是 memcpy 到映射区
+    size_t mmap_segment_size = 16 * 1024 * 1024;            // Mmap：每次预分配并映射的长度
+    size_t index_interval = 64 * 1024;          // Text：约每写出这么多字节在 <文件>.idx 中加一条时间索引，0 表示不写
+    std::string shm_channel;                    // 非空时不写本地文件，渲染好的行写入共享内存环，由 logcollector 汇总（Text/Json）
+    size_t shm_ring_size = 4 * 1024 * 1024;     // shm_channel：每个分片的共享内存环大小
+    bool collect_metrics = true;                // 统计调用方的入队计数和入队延迟（每个线程每 64 条采样一次）
+};
+
+// 分片模式下第 shard 个后台线程写入的文件名：app.log -> app.0.log, app.1.log, ...
+// 只有一个分片时就是 filename 本身
+std::string shardFileName(const std::string& filename, size_t shard, size_t shard_count);
+
+class Logger {
+public:
+    explicit Logger(const std::string& filename, const LoggerOptions& options = LoggerOptions());
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // 格式串是模板参数：logger.log<"User {} performed {}">(LogLevel::INFO, id, action)
+    // 占位符位置在编译期解析，个数与参数个数不一致时编译失败。
+    // 消息参数之后可以跟结构化字段：log<"login">(LogLevel::INFO, kv<"user">(id), kv<"ip">(addr))
+    // 调用方只记录调用点描述和原始参数，时间戳渲染、参数转文本和拼接都在后台线程完成
+    // 低于当前级别阈值时直接返回，不做任何参数转换和编码；
+    // 要连参数表达式本身都不求值，使用下面的 LOG_DEBUG/LOG_INFO/... 宏
+    template<FixedString Fmt, typename... Args>
+    void log(LogLevel level, Args&&... args) {
+        if (!shouldLog(level)) {
+            return;
+        }
+        emit<Fmt>(level, prepareArg(args)...);
+    }
+
+    bool shouldLog(LogLevel level) const {
+        return static_cast<int>(level) >= static_cast<int>(level_.load(std::memory_order_relaxed));
+    }
+
+    // 运行时调整级别阈值，对所有线程立即生效
+    void setLevel(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+    LogLevel level() const { return level_.load(std::memory_order_relaxed); }
+
+    // LOG_RATE_LIMITED 使用：调用点第一次被压制时登记，由 0 号分片的后台线程约每秒汇总一次。
+    // 同一个调用点用于多个 Logger 时只登记到第一个
+    void trackRateLimiter(RateLimiter& limiter, LogLevel level, std::string_view format);
+
+    // 因队列写满被丢弃的记录总数
+    uint64_t droppedCount() const { return drops_.total(); }
+    uint64_t droppedCount(LogLevel level) const { return drops_.count(level); }
+    // Shared 模式下参数缓冲区池不够用或记录过大而退回堆分配的次数
+    uint64_t recordPoolOverflows() const { return buffer_pool_.overflowCount(); }
+
+    // 取一次指标快照，可以从任意线程调用，开销与注册过的生产者线程数成正比。
+    // reset_peaks 为 true 时把 max_queue_depth 清零，下次快照得到的是两次之间的峰值。
+    // collect_metrics 为 false 时 records_enqueued、enqueue_latency 和 PerThread 模式的 queue_depth 为 0
+    LoggerMetrics metrics(bool reset_peaks = false);
+
+private:
+    template<FixedString Fmt, typename... Args>
+    void emit(LogLevel level, const Args&... args) {
+        using Codec = ArgCodec<StoredArg<Args>...>;
+        RecordHeader header;
+        header.timestamp = clock_.now();
+        header.site = &CallSite<Fmt, StoredArg<Args>...>::info;
+        header.payload_size = static_cast<uint32_t>(Codec::size(args...));
+        header.level = level;
+
+        bool enqueued;
+        if (queue_mode_ == QueueMode::PerThread) {
+            enqueued = stage(header, [&](char* dst) { Codec::encode(dst, args...); });
+        } else {
+            LogRecord record;
+            record.header = header;
+            record.payload = buffer_pool_.acquire(header.payload_size);
+            Codec::encode(record.payload.data(), args...);
+            enqueued = threadShard().log_queue.push(std::move(record));
+        }
+
+        if (collect_metrics_ && enqueued) {
+            ProducerMetrics* metrics = metrics_slot_.logger_id == id_ ? metrics_slot_.metrics : registerMetrics();
+            // 入队延迟按记录数采样，避免每次调用多读一次时钟
+            if (metrics->records.load() % kEnqueueLatencySampling == 0) {
+                metrics->enqueue_latency.record(clock_.elapsedNanos(header.timestamp, clock_.now()));
+            }
+            metrics->records.add(1);
+        }
+    }
+
+    // 一个后台线程及其独占的队列、批量缓冲和输出文件。
+    // 每个生产者线程固定属于一个分片，分片内按时间顺序写出，分片之间互不等待
+    struct Shard {
+        Shard(size_t index, const std::string& filename, const LoggerOptions& options, DropCounter* drops);
+
+        const size_t index;
+        LogQueue log_queue;             // Shared 模式
+        std::unique_ptr<RotatingFile> log_file;     // 写共享内存环时为空
+        std::unique_ptr<ShmLogRing> shm_ring;
+        bool shm_stalled = false;       // 上一批等待环空间超时，环腾出空间之前不再等待
+        std::thread worker_thread;
+
+        // 后台线程独占的批量写缓冲；有额外输出目标时写出后整批共享给各目标线程
+        std::shared_ptr<LogBatch> batch;
+        std::vector<std::shared_ptr<LogBatch>> batch_pool;
+        TimestampFormatter timestamp_formatter;
+        BinaryLogWriter binary_writer;
+        bool batch_has_error = false;
+        std::chrono::steady_clock::time_point last_write;
+
+        // PerThread 模式下分配到本分片的暂存缓冲区，注册/回收时递增 staging_version
+        std::mutex staging_mutex;
+        std::vector<std::shared_ptr<StagingBuffer>> staging_buffers;
+        std::atomic<uint64_t> staging_version{0};
+
+        // 指标，只由本分片的后台线程写入
+        MetricCounter records_written;
+        MetricCounter bytes_written;
+        MetricCounter batches_written;
+        MetricCounter max_queue_depth;
+        HistogramCounter write_lag;
+        HistogramCounter flush_duration;
+        bool batch_open = false;                            // 当前批次已有记录
+        std::chrono::steady_clock::time_point batch_opened; // 当前批次第一条记录被取出的时间
+    };
+
+    // Shared 模式下按线程序号把生产者分配到分片，只有一个分片时不取线程序号
+    Shard& threadShard() {
+        if (shards_.size() == 1) {
+            return *shards_[0];
+        }
+        static std::atomic<size_t> next_thread{0};
+        thread_local const size_t thread_index = next_thread.fetch_add(1, std::memory_order_relaxed);
+        return *shards_[thread_index % shards_.size()];
+    }
+
+    // 把记录直接编码进本线程的暂存缓冲区，只访问线程本地的缓存行。返回 false 表示被丢弃
+    template<typename Encode>
+    bool stage(const RecordHeader& header, Encode&& encode) {
+        StagingBuffer* buffer = staging_slot_.logger_id == id_ ? staging_slot_.buffer : registerThread();
+        const size_t size = sizeof(RecordHeader) + header.payload_size;
+        if (size > buffer->ring.maxRecordSize()) {
+            return stageOversized(buffer, header, encode);
+        }
+        char* dst = reserveStaging(buffer, size, header.level);
+        if (dst == nullptr) {
+            return false;
+        }
+        std::memcpy(dst, &header, sizeof(header));
+        encode(dst + sizeof(header));
+        buffer->ring.commit();
+        return true;
+    }
+
+    // 超过字节环单条上限的记录：在调用方格式化并截断成一个字符串参数
+    template<typename Encode>
+    bool stageOversized(StagingBuffer* buffer, const RecordHeader& header, Encode& encode) {
+        std::string payload(header.payload_size, '\0');
+        encode(&payload[0]);
+        std::string text;
+        header.site->format_fn(payload.data(), text);
+        text.resize(buffer->ring.maxRecordSize() - sizeof(RecordHeader) - sizeof(uint32_t));
+
+        using Codec = ArgCodec<std::string_view>;
+        RecordHeader truncated = header;
+        truncated.site = &CallSite<"{}", std::string_view>::info;
+        truncated.payload_size = static_cast<uint32_t>(Codec::size(text));
+        char* dst = reserveStaging(buffer, sizeof(RecordHeader) + truncated.payload_size, header.level);
+        if (dst == nullptr) {
+            return false;
+        }
+        std::memcpy(dst, &truncated, sizeof(truncated));
+        Codec::encode(dst + sizeof(truncated), text);
+        buffer->ring.commit();
+        return true;
+    }
+
+    // 字节环写满时按 OverflowPolicy 等待，返回 nullptr 表示本条记录被丢弃。
+    // 生产者不能替后台线程出队，DropOldest 在这里按 DropNewest 处理
+    char* reserveStaging(StagingBuffer* buffer, size_t size, LogLevel level) {
+        char* dst = buffer->ring.reserve(size);
+        if (dst != nullptr) {
+            return dst;
+        }
+        const bool may_wait = overflow_.policy == OverflowPolicy::Block ||
+            (overflow_.policy == OverflowPolicy::DropBelowLevel &&
+             static_cast<int>(level) >= static_cast<int>(overflow_.min_level));
+        if (may_wait) {
+            OverflowBackoff backoff(overflow_.block_timeout);
+            while ((dst = buffer->ring.reserve(size)) == nullptr) {
+                if (!backoff.wait()) {
+                    break;
+                }
+            }
+        }
+        if (dst == nullptr) {
+            drops_.add(level);
+        }
+        return dst;
+    }
+
+    void processQueue(Shard& shard);
+    void processStagingBuffers(Shard& shard);
+    size_t drainStagingBuffers(Shard& shard, const std::vector<std::shared_ptr<StagingBuffer>>& buffers);
+    void releaseRetiredBuffers(Shard& shard);
+    // 0 号分片的后台线程：丢弃停止后（一整轮没有新的丢弃）写一条汇总记录
+    void reportDrops(Shard& shard, bool force);
+    // 0 号分片的后台线程：约每秒为登记过的限流调用点输出被压制的条数，force 时不受间隔限制
+    void reportSuppressed(Shard& shard, bool force);
+    StagingBuffer* registerThread();
+    ProducerMetrics* registerMetrics();
+
+    // 后台线程：把一条记录渲染进本分片的批量缓冲
+    void appendRecord(Shard& shard, const RecordHeader& header, const char* payload);
+    // 后台线程：一轮取空后按 FlushPolicy 决定是否写出
+    void endBatch(Shard& shard);
+    void writeBatch(Shard& shard);
+    // 把批次中的行拷贝进共享内存环，返回拷贝的字节数
+    size_t writeShm(Shard& shard);
+    // 把刚写出的文本批次的时间范围分段报告给索引
+    void reportIndexRanges(Shard& shard);
+    // 把写出的批次交给各输出目标，换一个空闲的批次继续写
+    void publishBatch(Shard& shard);
+    std::chrono::milliseconds idleWait(const Shard& shard) const;
+
+    static inline thread_local ThreadStagingSlot staging_slot_{0, nullptr};
+    static inline thread_local ThreadMetricsSlot metrics_slot_{0, nullptr};
+
+    const uint64_t id_;
+    std::atomic<LogLevel> level_;
+    const QueueMode queue_mode_;
+    const size_t staging_buffer_size_;
+    const LogFormat format_;
+    const FlushPolicy flush_policy_;
+    const std::chrono::milliseconds flush_interval_;
+    const size_t write_buffer_size_;
+    LogClock clock_;
+    const OverflowOptions overflow_;
+    const bool collect_metrics_;
+    DropCounter drops_;
+    // 必须在 shards_ 之前构造、之后析构：队列中残留的记录析构时要归还缓冲区
+    RecordBufferPool buffer_pool_;
+    std::vector<std::unique_ptr<SinkChannel>> sink_channels_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<bool> exit_flag_;
+    // PerThread 模式下新注册的线程轮流分配到各分片
+    std::atomic<size_t> next_staging_shard_{0};
+
+    // 各生产者线程的计数块；线程退出后由 metrics() 并入 retired_*
+    std::mutex producers_mutex_;
+    std::vector<std::shared_ptr<ProducerMetrics>> producers_;
+    uint64_t retired_records_ = 0;
+    LatencyHistogram retired_enqueue_latency_;
+
+    // 只由 0 号分片的后台线程访问
+    uint64_t reported_drops_[kLogLevelCount] = {};
+    uint64_t last_round_drops_ = 0;
+    std::chrono::steady_clock::time_point next_suppressed_report_;
+
+    std::atomic<RateLimiter*> rate_limiters_{nullptr};
+};
+
+// 编译期最低级别：低于它的 LOG_* 宏展开为空，参数不参与编译也不会求值。
+// 通过 CMake 选项 LOGPRO_ACTIVE_LEVEL 或 -DLOGPRO_ACTIVE_LEVEL=LOGPRO_LEVEL_INFO 设置
+#define LOGPRO_LEVEL_DEBUG 0
+#define LOGPRO_LEVEL_INFO 1
+#define LOGPRO_LEVEL_WARN 2
+#define LOGPRO_LEVEL_ERROR 3
+
+#ifndef LOGPRO_ACTIVE_LEVEL
+#define LOGPRO_ACTIVE_LEVEL LOGPRO_LEVEL_DEBUG
+#endif
+
+// 先检查运行时阈值，通过后才对参数求值：
+// LOG_DEBUG(logger, "cache miss {}", expensiveKey());
+#define LOGPRO_LOG(logger, level, fmt, ...)                                      \
+    do {                                                                         \
+        if ((logger).shouldLog(level)) {                                         \
+            (logger).template log<fmt>(level __VA_OPT__(,) __VA_ARGS__);         \
+        }                                                                        \
+    } while (0)
+
+#if LOGPRO_ACTIVE_LEVEL <= LOGPRO_LEVEL_DEBUG
+#define LOG_DEBUG(logger, fmt, ...) LOGPRO_LOG(logger, LogLevel::DEBUG, fmt __VA_OPT__(,) __VA_ARGS__)
+#else
+#define LOG_DEBUG(logger, fmt, ...) ((void)0)
+#endif
+
+#if LOGPRO_ACTIVE_LEVEL <= LOGPRO_LEVEL_INFO
+#define LOG_INFO(logger, fmt, ...) LOGPRO_LOG(logger, LogLevel::INFO, fmt __VA_OPT__(,) __VA_ARGS__)
+#else
+#define LOG_INFO(logger, fmt, ...) ((void)0)
+#endif
+
+#if LOGPRO_ACTIVE_LEVEL <= LOGPRO_LEVEL_WARN
+#define LOG_WARN(logger, fmt, ...) LOGPRO_LOG(logger, LogLevel::WARN, fmt __VA_OPT__(,) __VA_ARGS__)
+#else
+#define LOG_WARN(logger, fmt, ...) ((void)0)
+#endif
+
+#if LOGPRO_ACTIVE_LEVEL <= LOGPRO_LEVEL_ERROR
+#define LOG_ERROR(logger, fmt, ...) LOGPRO_LOG(logger, LogLevel::ERROR, fmt __VA_OPT__(,) __VA_ARGS__)
+#else
+#define LOG_ERROR(logger, fmt, ...) ((void)0)
+#endif
+
+// 调用点限流：每个宏展开处一个静态令牌桶，每秒最多 per_second 条（允许同样大小的突发）。
+// 被压制的条数在之后某次放行时（或由后台线程约每秒一次）以汇总行输出，每个调用点最多每秒一行：
+// LOG_RATE_LIMITED(logger, LogLevel::WARN, 10, "upstream {} unavailable", host);
+#define LOG_RATE_LIMITED(logger, level, per_second, fmt, ...)                                   \
+    do {                                                                                        \
+        if ((logger).shouldLog(level)) {                                                        \
+            static RateLimiter logpro_limiter_(per_second, static_cast<uint32_t>(per_second));   \
+            uint64_t logpro_suppressed_ = 0;                                                    \
+            if (logpro_limiter_.tryAcquire(logpro_suppressed_)) {                               \
+                if (logpro_suppressed_ > 0) {                                                   \
+                    (logger).template log<"suppressed {} messages: {}">(                        \
+                        level, logpro_suppressed_, std::string_view(fmt));                      \
+                }                                                                               \
+                (logger).template log<fmt>(level __VA_OPT__(,) __VA_ARGS__);                    \
+            } else if (!logpro_limiter_.registered()) {                                         \
+                (logger).trackRateLimiter(logpro_limiter_, level, std::string_view(fmt));       \
+            }                                                                                   \
+        }                                                                                       \
+    } while (0)
+
+// 按概率采样：每次调用以 probability 的概率记录
+// LOG_SAMPLED(logger, LogLevel::DEBUG, 0.01, "cache lookup {}", key);
+#define LOG_SAMPLED(logger, level, probability, fmt, ...)                                       \
+    do {                                                                                        \
+        if ((logger).shouldLog(level)) {                                                        \
+            static const LogSampler logpro_sampler_(probability);                               \
+            if (logpro_sampler_.sample()) {                                                     \
+                (logger).template log<fmt>(level __VA_OPT__(,) __VA_ARGS__);                    \
+            }                                                                                   \
+        }                                                                                       \
+    } while (0)
+
+#endif // LOGGER_H
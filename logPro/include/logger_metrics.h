@@ -0,0 +1,109 @@
+#ifndef LOGGER_METRICS_H
+#define LOGGER_METRICS_H
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "log_record.h"
+
+// Logger 自身的运行指标，用 Logger::metrics() 取快照
+//
+// 每个计数器只有一个写者（生产者线程自己的计数块，或某个分片的后台线程），
+// 写入只是 relaxed 读加 relaxed 写，没有 lock 前缀的原子指令，也不与其他线程共享缓存行；
+// 取快照的线程随时读取并汇总，读到的是各计数器某一时刻的值
+
+// 按 2 的幂划分的延迟直方图：第 i 个桶统计 [2^i, 2^(i+1)) 纳秒，0 计入第 0 个桶，
+// 超过 2^39 纳秒（约 9 分钟）的都计入最后一个桶
+struct LatencyHistogram {
+    static constexpr size_t kBuckets = 40;
+
+    uint64_t buckets[kBuckets] = {};
+
+    static size_t bucketOf(uint64_t nanos) {
+        const size_t index = nanos == 0 ? 0 : static_cast<size_t>(std::bit_width(nanos)) - 1;
+        return index < kBuckets ? index : kBuckets - 1;
+    }
+
+    uint64_t count() const;
+    // 第 p（0..1）分位所在桶的上界（纳秒），没有样本时为 0
+    uint64_t percentile(double p) const;
+    void merge(const LatencyHistogram& other);
+};
+
+// 单写者计数器
+class MetricCounter {
+public:
+    void add(uint64_t n) {
+        value_.store(value_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+    // 只增不减的峰值，取快照时可以清零
+    void raise(uint64_t n) {
+        if (n > value_.load(std::memory_order_relaxed)) {
+            value_.store(n, std::memory_order_relaxed);
+        }
+    }
+    uint64_t load() const { return value_.load(std::memory_order_relaxed); }
+    uint64_t exchange(uint64_t n) { return value_.exchange(n, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+// 单写者直方图
+class HistogramCounter {
+public:
+    void record(uint64_t nanos) { buckets_[LatencyHistogram::bucketOf(nanos)].add(1); }
+
+    // 把当前计数累加到 out
+    void addTo(LatencyHistogram& out) const {
+        for (size_t i = 0; i < LatencyHistogram::kBuckets; ++i) {
+            out.buckets[i] += buckets_[i].load();
+        }
+    }
+
+private:
+    MetricCounter buckets_[LatencyHistogram::kBuckets];
+};
+
+// 每个生产者线程每隔多少条记录测量一次入队延迟
+constexpr uint64_t kEnqueueLatencySampling = 64;
+
+// 一个生产者线程的计数块，线程第一次写日志时向 Logger 注册
+struct alignas(64) ProducerMetrics {
+    MetricCounter records;              // 成功入队的记录
+    HistogramCounter enqueue_latency;   // log() 中取时间戳到记录入队的耗时（采样）
+    std::atomic<bool> retired{false};   // 线程已退出，计数并入 Logger 后可释放
+};
+
+// 线程本地的快速查找缓存：最近一次使用的 Logger 及本线程在其中的计数块
+struct ThreadMetricsSlot {
+    uint64_t logger_id;
+    ProducerMetrics* metrics;
+};
+
+// 某一时刻的指标快照。计数都是自 Logger 构造以来的累计值，
+// 速率由两次快照相减得到：later.bytesPerSecond(earlier)
+struct LoggerMetrics {
+    std::chrono::steady_clock::time_point taken_at;
+
+    uint64_t records_enqueued = 0;      // 生产者成功入队的记录
+    uint64_t records_written = 0;       // 后台线程已取出并渲染的记录
+    uint64_t queue_depth = 0;           // 当前积压（已入队、尚未被后台线程取出）
+    uint64_t max_queue_depth = 0;       // 各分片每轮开始处理时观察到的最大积压
+    uint64_t bytes_written = 0;         // 写入日志文件的字节数
+    uint64_t batches_written = 0;       // 写出次数
+    uint64_t dropped = 0;
+    uint64_t dropped_by_level[kLogLevelCount] = {};
+    uint64_t record_pool_overflows = 0;
+
+    LatencyHistogram enqueue_latency;   // 调用方：取时间戳到记录入队（含写满时的等待），每线程每 64 条采样一条
+    LatencyHistogram write_lag;         // 后台：批次中第一条记录被取出到整批写出
+    LatencyHistogram flush_duration;    // 后台：每次写出（write/writev/memcpy 和 fdatasync）的耗时
+
+    double bytesPerSecond(const LoggerMetrics& earlier) const;
+    double recordsPerSecond(const LoggerMetrics& earlier) const;
+};
+
+#endif // LOGGER_METRICS_H
@@ -0,0 +1,114 @@
+#ifndef MPMC_RING_H
+#define MPMC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// 有界无锁多生产者/多消费者环形队列（Vyukov 算法）
+// 槽位在构造时一次性分配，每个槽位带序号：
+//   sequence == pos      槽位空闲，可由生产者写入
+//   sequence == pos + 1  槽位已写入，可由消费者读取
+// 正常只有后台线程出队；OverflowPolicy::DropOldest 下生产者也会出队腾出槽位，
+// 所以出队端同样用 CAS 推进位置
+template<typename T>
+class MpmcRing {
+public:
+    // capacity 向上取整为 2 的幂
+    explicit MpmcRing(size_t capacity)
+        : capacity_(roundUpPowerOfTwo(capacity))
+        , mask_(capacity_ - 1)
+        , slots_(new Slot[capacity_]) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcRing(const MpmcRing&) = delete;
+    MpmcRing& operator=(const MpmcRing&) = delete;
+
+    // 多生产者调用，队列满时返回 false
+    template<typename U>
+    bool tryPush(U&& value) {
+        Slot* slot;
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            slot = &slots_[pos & mask_];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::forward<U>(value);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 多消费者调用，队列空时返回 false
+    bool tryPop(T& value) {
+        Slot* slot;
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            slot = &slots_[pos & mask_];
+            size_t seq = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(slot->value);
+        slot->sequence.store(pos + capacity_, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        return slots_[pos & mask_].sequence.load(std::memory_order_acquire) != pos + 1;
+    }
+
+    // 近似的元素个数：并发读写时可能包含已占位但尚未写完的槽位
+    size_t size() const {
+        const size_t dequeued = dequeue_pos_.load(std::memory_order_relaxed);
+        const size_t enqueued = enqueue_pos_.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t roundUpPowerOfTwo(size_t n) {
+        size_t result = 2;
+        while (result < n) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+};
+
+#endif // MPMC_RING_H
@@ -0,0 +1,82 @@
+#ifndef OVERFLOW_POLICY_H
+#define OVERFLOW_POLICY_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include "log_record.h"
+#include "spin_wait.h"
+
+// 队列（或 PerThread 模式下本线程的字节环）写满时如何处理新记录
+enum class OverflowPolicy {
+    Block,          // 等待后台线程腾出空间，超过 block_timeout 后丢弃
+    DropNewest,     // 直接丢弃新记录，调用方从不等待
+    DropOldest,     // 丢弃队列中最旧的记录（PerThread 模式下同 DropNewest）
+    DropBelowLevel  // 低于 min_level 的新记录直接丢弃，其余按 Block 处理
+};
+
+struct OverflowOptions {
+    OverflowPolicy policy = OverflowPolicy::Block;
+    // 默认最多等 1ms，后台线程卡住（磁盘满、输出目标过慢）时调用方不会被一直阻塞；
+    // 设为 microseconds::max() 表示一直等待，不丢日志
+    std::chrono::microseconds block_timeout = std::chrono::milliseconds(1);
+    LogLevel min_level = LogLevel::WARN;    // DropBelowLevel
+};
+
+// 按级别统计被丢弃的记录数，只在丢弃时写入
+class DropCounter {
+public:
+    void add(LogLevel level) {
+        counts_[static_cast<size_t>(level)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t count(LogLevel level) const {
+        return counts_[static_cast<size_t>(level)].load(std::memory_order_relaxed);
+    }
+
+    uint64_t total() const {
+        uint64_t sum = 0;
+        for (const auto& count : counts_) {
+            sum += count.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+private:
+    std::atomic<uint64_t> counts_[kLogLevelCount] = {};
+};
+
+// 写满时的等待：先自旋，再每 50us 休眠一次，直到超时
+class OverflowBackoff {
+public:
+    explicit OverflowBackoff(std::chrono::microseconds timeout)
+        : timeout_(timeout) {}
+
+    // 返回 false 表示已超时，调用方应放弃本条记录
+    bool wait() {
+        if (spin_.spinOnce()) {
+            return true;
+        }
+        if (timeout_ != std::chrono::microseconds::max()) {
+            auto now = std::chrono::steady_clock::now();
+            if (!deadline_set_) {
+                // 自旋阶段不读时钟，第一次休眠前才开始计时
+                deadline_ = now + timeout_;
+                deadline_set_ = true;
+            } else if (now >= deadline_) {
+                return false;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+        return true;
+    }
+
+private:
+    const std::chrono::microseconds timeout_;
+    SpinWait spin_;
+    bool deadline_set_ = false;
+    std::chrono::steady_clock::time_point deadline_;
+};
+
+#endif // OVERFLOW_POLICY_H
@@ -0,0 +1,110 @@
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <string_view>
+#include "log_record.h"
+
+// 限流用的粗粒度单调时钟：Linux 上 CLOCK_MONOTONIC_COARSE 走 vDSO，只读一个内存变量
+inline uint64_t coarseNanos() {
+#if defined(CLOCK_MONOTONIC_COARSE)
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// 单个调用点的令牌桶（GCRA 形式，只有一个原子变量）
+// 每秒放行 per_second 条，允许 burst 条的突发。被压制的条数累计起来，
+// 之后某次放行时若距上次汇总已超过 1 秒，通过 tryAcquire 的出参交给调用方输出汇总。
+// 调用点第一次被压制时登记到 Logger（Logger::trackRateLimiter），之后不再有放行的调用时
+// 由后台线程约每秒取走计数输出汇总，日志风暴结束后最后的压制条数也不会丢
+class RateLimiter {
+public:
+    RateLimiter(double per_second, uint32_t burst)
+        : interval_(static_cast<uint64_t>(1e9 / (per_second > 0 ? per_second : 1)))
+        , tolerance_(interval_ * (burst > 0 ? burst - 1 : 0)) {}
+
+    bool tryAcquire(uint64_t& suppressed) {
+        const uint64_t now = coarseNanos();
+        uint64_t tat = tat_.load(std::memory_order_relaxed);
+        for (;;) {
+            if (tat > now + tolerance_) {
+                suppressed_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            const uint64_t next = std::max(tat, now) + interval_;
+            if (tat_.compare_exchange_weak(tat, next, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        suppressed = takeSuppressed(now);
+        return true;
+    }
+
+    // 取走被压制的条数；距上次汇总不到 1 秒时返回 0，force 为 true 时（Logger 退出）不受限制
+    uint64_t takeSuppressed(uint64_t now, bool force = false) {
+        if (suppressed_.load(std::memory_order_relaxed) == 0) {
+            return 0;
+        }
+        uint64_t last = last_report_.load(std::memory_order_relaxed);
+        if (!force && (now - last < kReportInterval ||
+                       !last_report_.compare_exchange_strong(last, now, std::memory_order_relaxed))) {
+            return 0;
+        }
+        return suppressed_.exchange(0, std::memory_order_relaxed);
+    }
+
+    // ---- 由 Logger 登记，后台线程汇总 ----
+
+    bool registered() const { return registered_.load(std::memory_order_acquire); }
+    // 只有第一次调用返回 true
+    bool claimRegistration() { return !registered_.exchange(true, std::memory_order_acq_rel); }
+    void releaseRegistration() { registered_.store(false, std::memory_order_release); }
+
+    RateLimiter* next_registered = nullptr;    // Logger 中的登记链表
+    LogLevel report_level = LogLevel::INFO;     // 汇总行的级别和格式串，登记时写入
+    std::string_view report_format;
+
+private:
+    static constexpr uint64_t kReportInterval = 1000000000ull;
+
+    const uint64_t interval_;
+    const uint64_t tolerance_;
+    std::atomic<uint64_t> tat_{0};              // 理论上下一条到达的时间
+    std::atomic<uint64_t> suppressed_{0};
+    std::atomic<uint64_t> last_report_{0};
+    std::atomic<bool> registered_{false};
+};
+
+// 按概率采样，每个线程一个 xorshift 状态，不访问共享变量
+class LogSampler {
+public:
+    explicit LogSampler(double probability)
+        : threshold_(probability >= 1.0 ? ~static_cast<uint64_t>(0)
+                     : probability <= 0.0 ? 0
+                     : static_cast<uint64_t>(probability * 18446744073709551616.0)) {}
+
+    bool sample() const {
+        thread_local uint64_t state = 0;
+        if (state == 0) {
+            state = reinterpret_cast<uintptr_t>(&state) ^ coarseNanos() ^ 0x9E3779B97F4A7C15ull;
+        }
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state < threshold_;
+    }
+
+private:
+    const uint64_t threshold_;
+};
+
+#endif // RATE_LIMITER_H
@@ -0,0 +1,108 @@
+#ifndef RECORD_BUFFER_POOL_H
+#define RECORD_BUFFER_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "mpmc_ring.h"
+
+class RecordBufferPool;
+
+// 记录参数缓冲区的所有权，只能移动
+// 析构或 reset() 时池内缓冲区归还到池中，溢出分配的缓冲区直接释放
+class PooledBuffer {
+public:
+    PooledBuffer() = default;
+    PooledBuffer(PooledBuffer&& other) noexcept
+        : data_(other.data_)
+        , pool_(other.pool_) {
+        other.data_ = nullptr;
+    }
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept {
+        if (this != &other) {
+            reset();
+            data_ = other.data_;
+            pool_ = other.pool_;
+            other.data_ = nullptr;
+        }
+        return *this;
+    }
+    ~PooledBuffer() { reset(); }
+
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    char* data() const { return data_; }
+    inline void reset();
+
+private:
+    friend class RecordBufferPool;
+    PooledBuffer(char* data, RecordBufferPool* pool)
+        : data_(data)
+        , pool_(pool) {}
+
+    char* data_ = nullptr;
+    RecordBufferPool* pool_ = nullptr;
+};
+
+// 固定大小的记录缓冲区池（Shared 模式）
+// 构造时一次性分配 count 个 buffer_size 字节的缓冲区，空闲缓冲区放在无锁环形队列里：
+// 生产者取出、填好参数后随记录移动进 LogQueue，后台线程渲染完归还。
+// 参数超过 buffer_size 或池已取空时退回堆分配，稳定状态下不调用 malloc/free
+class RecordBufferPool {
+public:
+    RecordBufferPool(size_t buffer_size, size_t count)
+        : buffer_size_(roundUp(buffer_size == 0 ? 64 : buffer_size))
+        , count_(count)
+        , slab_(count == 0 ? nullptr : new char[buffer_size_ * count])
+        , free_(count == 0 ? 1 : count) {
+        for (size_t i = 0; i < count_; ++i) {
+            free_.tryPush(slab_.get() + i * buffer_size_);
+        }
+    }
+
+    RecordBufferPool(const RecordBufferPool&) = delete;
+    RecordBufferPool& operator=(const RecordBufferPool&) = delete;
+
+    PooledBuffer acquire(size_t size) {
+        char* data;
+        if (size <= buffer_size_ && free_.tryPop(data)) {
+            return PooledBuffer(data, this);
+        }
+        overflow_count_.fetch_add(1, std::memory_order_relaxed);
+        return PooledBuffer(new char[size == 0 ? 1 : size], this);
+    }
+
+    size_t bufferSize() const { return buffer_size_; }
+    // 退回堆分配的次数
+    uint64_t overflowCount() const { return overflow_count_.load(std::memory_order_relaxed); }
+
+private:
+    friend class PooledBuffer;
+
+    static size_t roundUp(size_t size) { return (size + 63) / 64 * 64; }
+
+    void release(char* data) {
+        if (slab_ != nullptr && data >= slab_.get() && data < slab_.get() + buffer_size_ * count_) {
+            free_.tryPush(data);
+        } else {
+            delete[] data;
+        }
+    }
+
+    const size_t buffer_size_;
+    const size_t count_;
+    std::unique_ptr<char[]> slab_;
+    MpmcRing<char*> free_;
+    std::atomic<uint64_t> overflow_count_{0};
+};
+
+inline void PooledBuffer::reset() {
+    if (data_ != nullptr) {
+        pool_->release(data_);
+        data_ = nullptr;
+    }
+}
+
+#endif // RECORD_BUFFER_POOL_H
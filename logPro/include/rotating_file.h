@@ -0,0 +1,119 @@
+#ifndef ROTATING_FILE_H
+#define ROTATING_FILE_H
+
+#include <string>
+#include <chrono>
+#include <memory>
+#include <string_view>
+#include "compression_worker.h"
+#include "log_index.h"
+
+// 日志轮转策略
+struct RotationPolicy {
+    size_t max_file_size = 64 * 1024 * 1024;        // 单个文件的最大字节数，0 表示不按大小轮转
+    std::chrono::seconds max_file_age{0};           // 单个文件的最长写入时间，0 表示不按时间轮转
+    bool compress = true;                           // 是否用 zstd 压缩轮转出来的日志段
+    int compression_level = 3;                      // zstd 压缩级别
+    size_t max_compress_threads = 1;                // 同时进行的压缩任务上限
+    size_t max_pending_compressions = 16;           // 等待压缩的日志段上限，超出的段不压缩
+};
+
+// 写文件的方式
+enum class FileWriteMode {
+    Write,  // write/writev 系统调用
+    Mmap    // 按段预分配并映射文件，写入只是 memcpy
+};
+
+// 按大小/时间轮转的日志文件，只在后台写线程中使用
+// 直接用文件描述符写入整批数据，一批只需一次 write/writev 系统调用；
+// 调用方在批次之间调用 rotateIfNeeded()，因此单个文件最多超出 max_file_size 一个批次。
+// 轮转时把当前文件改名为 <stem>.<时间>-<序号><ext>，再交给 CompressionWorker 压缩。
+//
+// FileWriteMode::Mmap：文件按 mmap_segment_size 预分配（posix_fallocate，磁盘满时不会 SIGBUS）
+// 并映射当前段，写入只是 memcpy 加尾指针前移，写满一段再映射下一段。
+// 页面归内核所有，进程崩溃时已拷贝进映射的日志不会丢失。实际数据长度同样映射写入旁路文件
+// <文件>.len，每次拷贝后更新；正常关闭时截断到实际长度并删除 .len，崩溃后重新打开时
+// 按 .len 中的长度截掉预分配部分再继续追加。预分配失败时退回 write 方式
+//
+// index_interval > 0 时维护 <文件>.idx 时间索引（见 log_index.h）：调用方每写出一批后用
+// addIndexRange() 报告这批数据的时间范围（大批次按约 index_interval 字节分段报告），
+// 累计超过 index_interval 字节就追加一条索引。
+// 轮转时索引随日志段改名，压缩线程据此把日志段按索引条目分帧压缩
+class RotatingFile {
+public:
+    RotatingFile(const std::string& filename, const RotationPolicy& policy,
+                 FileWriteMode mode = FileWriteMode::Write,
+                 size_t mmap_segment_size = 16 * 1024 * 1024,
+                 size_t index_interval = 0);
+    ~RotatingFile();
+
+    RotatingFile(const RotatingFile&) = delete;
+    RotatingFile& operator=(const RotatingFile&) = delete;
+
+    // 达到大小/时间上限时轮转，返回是否发生了轮转
+    bool rotateIfNeeded();
+    // 写入一批日志
+    void write(std::string_view data);
+    // 用一次 writev 写入多段数据
+    void write(const std::string_view* parts, size_t count);
+    // 上一次报告之后写入的全部数据包含的记录范围
+    void addIndexRange(const IndexRange& range);
+    // 上一次报告之后写入的数据中，接下来 size 字节包含的记录范围。
+    // 一次写出的大批次可以分几段报告，使索引条目保持在 index_interval 左右
+    void addIndexRange(const IndexRange& range, size_t size);
+    // 把已写入的数据落盘（fdatasync）
+    void sync();
+    void rotate();
+
+    const std::string& filename() const { return filename_; }
+    size_t currentSize() const { return current_size_; }
+    // 构造以来写入的日志字节数（跨轮转累计，不含索引文件）
+    uint64_t bytesWritten() const { return bytes_written_; }
+    // 每打开一个新文件加一，二进制格式据此判断是否需要重写文件头和格式字典
+    uint64_t generation() const { return generation_; }
+    size_t indexInterval() const { return index_interval_; }
+    // 当前索引条目已累计（已报告范围）的字节数
+    size_t indexChunkBytes() const { return index_covered_ - index_chunk_start_; }
+
+private:
+    bool shouldRotate() const;
+    void open();
+    void close();
+    void writeAll(const char* data, size_t size);
+    std::string nextSegmentName();
+    // 把累计的索引范围写成一条索引条目
+    void flushIndexEntry();
+
+    // ---- FileWriteMode::Mmap ----
+    void openMapped();
+    void closeMapped();
+    void copyToMapping(const char* data, size_t size);
+    bool mapWindow(size_t offset);
+    size_t recoverMappedSize(size_t file_size);
+    bool openLengthFile();
+    void closeLengthFile();
+
+    std::string filename_;
+    RotationPolicy policy_;
+    const FileWriteMode mode_;
+    const size_t mmap_segment_size_;
+    bool mapped_ = false;       // 当前文件是否在用 mmap 方式写入
+    char* map_ = nullptr;
+    size_t map_offset_ = 0;     // 映射窗口在文件中的起始位置（页对齐）
+    size_t map_size_ = 0;
+    uint64_t* mapped_length_ = nullptr;  // 映射中的 <文件>.len 长度字段
+    int fd_ = -1;
+    size_t current_size_ = 0;
+    uint64_t bytes_written_ = 0;
+    std::chrono::steady_clock::time_point opened_at_;
+    unsigned sequence_ = 0;
+    uint64_t generation_ = 0;
+    const size_t index_interval_;
+    int index_fd_ = -1;
+    size_t index_chunk_start_ = 0;  // 当前索引条目在日志文件中的起始位置
+    size_t index_covered_ = 0;      // 已报告过范围的数据的结束位置
+    IndexRange index_chunk_;
+    std::unique_ptr<CompressionWorker> compressor_;
+};
+
+#endif // ROTATING_FILE_H
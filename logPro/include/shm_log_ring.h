@@ -0,0 +1,116 @@
+#ifndef SHM_LOG_RING_H
+#define SHM_LOG_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "log_record.h"
+
+// 跨进程的日志传输：POSIX 共享内存中的单生产者/单消费者字节环
+//
+// 每个进程的每个后台线程（分片）创建一个环 /logpro.<channel>.<pid>.<shard>，
+// 把渲染好的日志行连同时间戳拷贝进去；logcollector 扫描 /dev/shm 中同一 channel 的所有环，
+// 按时间戳归并后统一写文件（轮转、压缩、时间索引都在收集器中完成）。
+//
+//   共享内存 = ShmRingHeader 数据区（capacity 字节，2 的幂）
+//   数据区中每条记录 = 8 字节长度头 ShmRecordHeader 文本，按 8 字节对齐，不跨越环尾
+//
+// 消费位置保存在共享内存中，收集器把记录写入文件后才提交，重启后从上次提交的位置继续。生产者退出时只标记 closed，
+// 由收集器取空后删除；生产者崩溃（pid 不存在）时同样取空后删除。
+namespace shmlog {
+
+constexpr char kMagic[4] = {'L', 'P', 'S', 'R'};
+constexpr uint32_t kVersion = 1;
+constexpr const char* kNamePrefix = "logpro.";
+
+struct ShmRingHeader {
+    std::atomic<uint32_t> magic;    // 初始化完成后最后写入，收集器看到 magic 才开始读取
+    uint32_t version;
+    uint64_t capacity;
+    int32_t pid;
+    std::atomic<uint32_t> closed;   // 生产者已关闭，不会再写入
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) std::atomic<uint64_t> head;
+};
+
+struct ShmRecordHeader {
+    uint64_t nanos;     // 自 epoch 起的纳秒
+    uint32_t level;     // static_cast<uint32_t>(LogLevel)
+    uint32_t reserved;
+};
+
+// 共享内存对象名（shm_open 使用，带前导 '/'）：/logpro.<channel>.<pid>.<shard>
+std::string segmentName(const std::string& channel, int pid, size_t shard);
+
+} // namespace shmlog
+
+class ShmLogRing {
+public:
+    ShmLogRing() = default;
+    ~ShmLogRing();
+
+    ShmLogRing(const ShmLogRing&) = delete;
+    ShmLogRing& operator=(const ShmLogRing&) = delete;
+
+    // 生产者：创建并初始化共享内存环，同名的残留对象（pid 被复用）先删除。失败时返回 false 并设置 error()
+    bool create(const std::string& name, size_t capacity);
+    // 收集器：映射已有的环，对方尚未初始化完成时返回 false
+    bool attach(const std::string& name);
+    // 生产者：标记关闭并解除映射，共享内存对象留给收集器删除
+    void close();
+    // 收集器：删除共享内存对象（已映射的部分仍可访问）
+    void unlink();
+
+    const std::string& name() const { return name_; }
+    const std::string& error() const { return error_; }
+    int pid() const;
+    bool producerClosed() const;
+
+    // ---- 生产者 ----
+
+    // 写入一条记录但不发布，空间不足时返回 false；text 超过容量的一半时截断
+    bool append(uint64_t nanos, LogLevel level, std::string_view text);
+    // 发布之前 append() 的全部记录
+    void publish();
+
+    // ---- 消费者 ----
+
+    // 刷新可读范围，返回当前可读字节数；front() 只读取刷新时已发布的记录
+    size_t refresh();
+    // 下一条记录，没有则返回 false
+    bool front(shmlog::ShmRecordHeader& header, std::string_view& text);
+    // 跳过 front() 返回的记录，空间要等 commit() 后才交还给生产者
+    void pop();
+    // 把消费位置写回共享内存：收集器在 pop() 过的记录写入文件之后调用，崩溃重启后从这里继续
+    void commit();
+
+private:
+    static constexpr size_t kLengthSize = 8;
+    static constexpr uint64_t kWrapMarker = ~static_cast<uint64_t>(0);
+
+    static size_t alignUp(size_t n) { return (n + 7) & ~static_cast<size_t>(7); }
+
+    bool map(int fd, size_t size);
+    char* data() const;
+
+    std::string name_;
+    std::string error_;
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+    shmlog::ShmRingHeader* header_ = nullptr;
+    size_t capacity_ = 0;
+    size_t mask_ = 0;
+    bool producer_ = false;
+
+    // 生产者独占
+    uint64_t producer_tail_ = 0;
+    uint64_t producer_head_cache_ = 0;
+    // 消费者独占
+    uint64_t consumer_head_ = 0;
+    uint64_t consumer_tail_cache_ = 0;
+    size_t front_size_ = 0;
+};
+
+#endif // SHM_LOG_RING_H
@@ -0,0 +1,40 @@
+#ifndef SHM_LOG_WRITER_H
+#define SHM_LOG_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+class ShmLogRing;
+
+// 不使用 Logger 的进程向 logcollector 交付日志：每个进程一个共享内存环 /logpro.<channel>.<pid>.0
+//
+// 头文件只依赖 C++11，也不引入 log_record.h 的 LogLevel，
+// C++11 的程序（例如 base_frame）可以直接包含并链接 logpro。
+// 行的格式由调用方决定，收集器原样写入；不是线程安全的，多个线程写入时由调用方加锁
+class ShmLogWriter {
+public:
+    ShmLogWriter();
+    ~ShmLogWriter();
+
+    ShmLogWriter(const ShmLogWriter&) = delete;
+    ShmLogWriter& operator=(const ShmLogWriter&) = delete;
+
+    // 创建共享内存环，失败时返回 false 并设置 error()
+    bool open(const std::string& channel, size_t capacity = 4 * 1024 * 1024);
+    // 写入并发布一行（应以 '\n' 结尾）；level 取 0..3 对应 DEBUG..ERROR。
+    // 环已满（收集器没有跟上或没有运行）时不等待，返回 false
+    bool write(uint64_t nanos, uint32_t level, const char* text, size_t length);
+    // 标记关闭，剩余的记录由收集器取空后删除共享内存对象
+    void close();
+
+    bool isOpen() const { return ring_ != nullptr; }
+    const std::string& error() const { return error_; }
+
+private:
+    std::unique_ptr<ShmLogRing> ring_;
+    std::string error_;
+};
+
+#endif // SHM_LOG_WRITER_H
@@ -0,0 +1,36 @@
+#ifndef SINK_CHANNEL_H
+#define SINK_CHANNEL_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "log_sink.h"
+
+// 一个输出目标的专用线程和有界批次队列
+// Logger 后台线程每写出一批就 publish 一次；队列已满说明该目标跟不上，
+// 直接丢弃这一批并计入 droppedLines()，后台线程从不等待输出目标
+class SinkChannel {
+public:
+    explicit SinkChannel(std::shared_ptr<LogSink> sink);
+    // 写完队列中剩余的批次后退出
+    ~SinkChannel();
+
+    SinkChannel(const SinkChannel&) = delete;
+    SinkChannel& operator=(const SinkChannel&) = delete;
+
+    void publish(const std::shared_ptr<const LogBatch>& batch);
+
+private:
+    void run();
+
+    std::shared_ptr<LogSink> sink_;
+    std::deque<std::shared_ptr<const LogBatch>> pending_;
+    std::mutex mutex_;
+    std::condition_variable cond_var_;
+    bool is_shutdown_ = false;
+    std::thread worker_;
+};
+
+#endif // SINK_CHANNEL_H
@@ -0,0 +1,54 @@
+#ifndef SOCKET_SINK_H
+#define SOCKET_SINK_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <sys/socket.h>
+#include "log_sink.h"
+
+// UDP 远程输出：每个数据报装入若干完整的行，超过 max_datagram 的单行被截断，
+// 不足一个数据报的行留到下一次写入或 flush() 时发送。
+// 发送失败（对端不可达、缓冲区满）直接丢弃，不重试
+class UdpSink : public LogSink {
+public:
+    UdpSink(const std::string& host, uint16_t port, LogLevel level = LogLevel::DEBUG,
+            size_t max_datagram = 1400);
+    ~UdpSink() override;
+
+    void flush() override;
+
+protected:
+    void writeText(std::string_view text) override;
+
+private:
+    void send(std::string_view datagram);
+
+    int fd_ = -1;
+    const size_t max_datagram_;
+    std::string pending_;
+};
+
+// TCP 远程输出：第一次写入时连接，断开后每隔 reconnect_interval 重连一次，
+// 未连接期间的日志计入 droppedLines()。连接和发送都有超时，最长只阻塞本目标的线程
+class TcpSink : public LogSink {
+public:
+    TcpSink(const std::string& host, uint16_t port, LogLevel level = LogLevel::DEBUG,
+            std::chrono::milliseconds reconnect_interval = std::chrono::milliseconds(1000));
+    ~TcpSink() override;
+
+protected:
+    void writeText(std::string_view text) override;
+
+private:
+    bool ensureConnected();
+    void disconnect();
+
+    std::string host_;
+    uint16_t port_;
+    const std::chrono::milliseconds reconnect_interval_;
+    int fd_ = -1;
+    std::chrono::steady_clock::time_point next_attempt_;
+};
+
+#endif // SOCKET_SINK_H
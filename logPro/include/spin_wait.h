@@ -0,0 +1,85 @@
+#ifndef SPIN_WAIT_H
+#define SPIN_WAIT_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// 自旋等待时提示 CPU 降低功耗、让出流水线给超线程
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// 自适应等待：先忙等，再让出时间片，都失败后由调用方进入休眠
+class SpinWait {
+public:
+    // 返回 false 表示自旋预算用完，应当休眠
+    bool spinOnce() {
+        if (count_ < kSpinCount) {
+            cpuRelax();
+        } else if (count_ < kSpinCount + kYieldCount) {
+            std::this_thread::yield();
+        } else {
+            return false;
+        }
+        ++count_;
+        return true;
+    }
+
+    void reset() { count_ = 0; }
+
+private:
+    static constexpr unsigned kSpinCount = 256;
+    static constexpr unsigned kYieldCount = 64;
+    unsigned count_ = 0;
+};
+
+// 单消费者的休眠/唤醒
+// 生产者发布数据后调用 notify()，只有消费者真正休眠时才会加锁发信号，
+// 正常情况下每条消息只多一次原子读
+class ConsumerParker {
+public:
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked_.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cond_var_.notify_one();
+        }
+    }
+
+    // 消费者调用，ready() 为 true 时立即返回，否则最多休眠 max_wait
+    template<typename Ready>
+    void park(Ready ready, std::chrono::milliseconds max_wait) {
+        parked_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!ready()) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_var_.wait_for(lock, max_wait, ready);
+        }
+        parked_.store(false, std::memory_order_relaxed);
+    }
+
+    void wakeAll() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cond_var_.notify_all();
+    }
+
+private:
+    alignas(64) std::atomic<bool> parked_{false};
+    std::mutex mutex_;
+    std::condition_variable cond_var_;
+};
+
+#endif // SPIN_WAIT_H
@@ -0,0 +1,135 @@
+#ifndef SPSC_BYTE_RING_H
+#define SPSC_BYTE_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+// 单生产者/单消费者变长字节环
+// 每条记录前有 8 字节长度头，记录按 8 字节对齐且不会跨越环尾；
+// 环尾放不下时写入一个绕回标记，从环首继续写。
+// 生产者和消费者各自缓存对方的位置，只有缓存看起来不够用时才读取对方的原子变量，
+// 因此稳定状态下生产者只访问本线程独占的缓存行。
+class SpscByteRing {
+public:
+    // capacity 向上取整为 2 的幂
+    explicit SpscByteRing(size_t capacity)
+        : capacity_(roundUpPowerOfTwo(capacity))
+        , mask_(capacity_ - 1)
+        , buffer_(new char[capacity_]) {}
+
+    SpscByteRing(const SpscByteRing&) = delete;
+    SpscByteRing& operator=(const SpscByteRing&) = delete;
+
+    // 单条记录的最大长度
+    size_t maxRecordSize() const { return capacity_ / 2 - kHeaderSize; }
+
+    // ---- 生产者 ----
+
+    // 预留 size 字节的连续空间，空间不足时返回 nullptr；写完后调用 commit()
+    char* reserve(size_t size) {
+        if (size > maxRecordSize()) {
+            return nullptr;
+        }
+        const size_t need = alignUp(size + kHeaderSize);
+        size_t tail = producer_tail_;
+        size_t offset = tail & mask_;
+        size_t to_end = capacity_ - offset;
+        size_t total = need <= to_end ? need : to_end + need;
+
+        if (tail + total - producer_head_cache_ > capacity_) {
+            producer_head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail + total - producer_head_cache_ > capacity_) {
+                return nullptr;
+            }
+        }
+
+        if (need > to_end) {
+            writeHeader(offset, kWrapMarker);
+            tail += to_end;
+            offset = 0;
+        }
+        writeHeader(offset, static_cast<uint64_t>(size));
+        pending_tail_ = tail + need;
+        return buffer_.get() + offset + kHeaderSize;
+    }
+
+    // 发布最近一次 reserve() 的记录
+    void commit() {
+        producer_tail_ = pending_tail_;
+        tail_.store(producer_tail_, std::memory_order_release);
+    }
+
+    // ---- 消费者 ----
+
+    // 刷新可读范围，返回当前可读字节数；front() 只读取刷新时已发布的记录
+    size_t refresh() {
+        consumer_tail_cache_ = tail_.load(std::memory_order_acquire);
+        return consumer_tail_cache_ - consumer_head_;
+    }
+
+    // 返回下一条记录，没有则返回 nullptr
+    const char* front(size_t& size) {
+        if (consumer_head_ == consumer_tail_cache_) {
+            return nullptr;
+        }
+        size_t offset = consumer_head_ & mask_;
+        uint64_t header = readHeader(offset);
+        if (header == kWrapMarker) {
+            consumer_head_ += capacity_ - offset;
+            offset = 0;
+            header = readHeader(offset);
+        }
+        size = static_cast<size_t>(header);
+        return buffer_.get() + offset + kHeaderSize;
+    }
+
+    // 释放 front() 返回的记录
+    void pop(size_t size) {
+        consumer_head_ += alignUp(size + kHeaderSize);
+        head_.store(consumer_head_, std::memory_order_release);
+    }
+
+private:
+    static constexpr size_t kHeaderSize = 8;
+    static constexpr uint64_t kWrapMarker = ~static_cast<uint64_t>(0);
+
+    static size_t alignUp(size_t n) { return (n + 7) & ~static_cast<size_t>(7); }
+
+    static size_t roundUpPowerOfTwo(size_t n) {
+        size_t result = 64;
+        while (result < n) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    void writeHeader(size_t offset, uint64_t value) {
+        std::memcpy(buffer_.get() + offset, &value, sizeof(value));
+    }
+
+    uint64_t readHeader(size_t offset) const {
+        uint64_t value;
+        std::memcpy(&value, buffer_.get() + offset, sizeof(value));
+        return value;
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<char[]> buffer_;
+
+    // 生产者独占
+    alignas(64) size_t producer_tail_ = 0;
+    size_t pending_tail_ = 0;
+    size_t producer_head_cache_ = 0;
+    // 消费者独占
+    alignas(64) size_t consumer_head_ = 0;
+    size_t consumer_tail_cache_ = 0;
+    // 共享位置
+    alignas(64) std::atomic<size_t> tail_{0};
+    alignas(64) std::atomic<size_t> head_{0};
+};
+
+#endif // SPSC_BYTE_RING_H
@@ -0,0 +1,26 @@
+#ifndef THREAD_STAGING_H
+#define THREAD_STAGING_H
+
+#include <atomic>
+#include <cstdint>
+#include "spsc_byte_ring.h"
+
+// 每个生产者线程独占的暂存缓冲区（QueueMode::PerThread）
+// 线程第一次写日志时向 Logger 注册，之后只写本线程的 SPSC 字节环，
+// 每条记录是 RecordHeader 加编码后的参数
+struct StagingBuffer {
+    explicit StagingBuffer(size_t capacity)
+        : ring(capacity) {}
+
+    SpscByteRing ring;
+    std::atomic<bool> retired{false};   // 生产者线程已退出，取空后可回收
+    std::atomic<bool> detached{false};  // Logger 已析构，生产者线程可释放
+};
+
+// 线程本地的快速查找缓存：最近一次使用的 Logger 及其暂存缓冲区
+struct ThreadStagingSlot {
+    uint64_t logger_id;
+    StagingBuffer* buffer;
+};
+
+#endif // THREAD_STAGING_H
@@ -0,0 +1,285 @@
+#include "binary_log_reader.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+BinaryLogReader::~BinaryLogReader() {
+    if (mapping_ != nullptr) {
+        munmap(mapping_, size_);
+    }
+}
+
+bool BinaryLogReader::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error_ = "无法打开文件: " + path;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(binlog::FileHeader))) {
+        ::close(fd);
+        error_ = "不是二进制日志文件: " + path;
+        return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    mapping_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        error_ = "无法映射文件: " + path;
+        return false;
+    }
+
+    const char* begin = static_cast<const char*>(mapping_);
+    const char* end = begin + size_;
+    binlog::FileHeader file_header;
+    std::memcpy(&file_header, begin, sizeof(file_header));
+    if (std::memcmp(file_header.magic, binlog::kFileMagic, sizeof(file_header.magic)) != 0 ||
+        file_header.version != binlog::kFileVersion) {
+        error_ = "不是二进制日志文件: " + path;
+        return false;
+    }
+
+    const char* ptr = begin + sizeof(file_header);
+    while (static_cast<size_t>(end - ptr) >= sizeof(binlog::BlockHeader)) {
+        Block block;
+        std::memcpy(&block.header, ptr, sizeof(block.header));
+        if (block.header.magic != binlog::kBlockMagic) {
+            error_ = "块头损坏，停止在偏移 " + std::to_string(ptr - begin);
+            break;
+        }
+        const char* dict = ptr + sizeof(block.header);
+        const size_t body = static_cast<size_t>(block.header.dict_size) + block.header.records_size;
+        if (static_cast<size_t>(end - dict) < body) {
+            // 进程崩溃时最后一个块可能只写了一部分
+            break;
+        }
+        if (!parseDictionary(dict, dict + block.header.dict_size)) {
+            error_ = "格式字典损坏，停止在偏移 " + std::to_string(ptr - begin);
+            break;
+        }
+        block.records = dict + block.header.dict_size;
+        blocks_.push_back(block);
+        ptr = dict + body;
+    }
+    return true;
+}
+
+bool BinaryLogReader::parseDictionary(const char* ptr, const char* end) {
+    while (ptr < end) {
+        uint64_t id;
+        if (!binlog::getVarint(ptr, end, id) || ptr >= end) {
+            return false;
+        }
+        const size_t arg_count = static_cast<uint8_t>(*ptr++);
+        if (static_cast<size_t>(end - ptr) < arg_count) {
+            return false;
+        }
+        Format format;
+        for (size_t i = 0; i < arg_count; ++i) {
+            format.arg_types.push_back(static_cast<ArgType>(*ptr++));
+        }
+        uint64_t length;
+        if (!binlog::getVarint(ptr, end, length) || static_cast<uint64_t>(end - ptr) < length) {
+            return false;
+        }
+        std::string_view text(ptr, static_cast<size_t>(length));
+        ptr += length;
+
+        if (ptr >= end) {
+            return false;
+        }
+        const size_t field_count = static_cast<uint8_t>(*ptr++);
+        for (size_t i = 0; i < field_count; ++i) {
+            uint64_t key_length;
+            if (!binlog::getVarint(ptr, end, key_length) || static_cast<uint64_t>(end - ptr) < key_length) {
+                return false;
+            }
+            format.fields.emplace_back(ptr, static_cast<size_t>(key_length));
+            ptr += key_length;
+        }
+
+        size_t start = 0;
+        size_t pos;
+        while ((pos = text.find("{}", start)) != std::string_view::npos) {
+            format.segments.emplace_back(text.substr(start, pos - start));
+            start = pos + 2;
+        }
+        format.segments.emplace_back(text.substr(start));
+        if (field_count > arg_count || format.segments.size() != arg_count - field_count + 1) {
+            return false;
+        }
+
+        if (formats_.size() <= id) {
+            formats_.resize(id + 1);
+        }
+        formats_[id] = std::move(format);
+    }
+    return true;
+}
+
+size_t BinaryLogReader::decodeBlock(const Block& block, const RecordFilter& filter,
+                                    TimestampFormatter& formatter, std::string& out, bool json) const {
+    if (block.header.max_timestamp < filter.from || block.header.min_timestamp > filter.to) {
+        return 0;
+    }
+
+    const char* ptr = block.records;
+    const char* end = block.records + block.header.records_size;
+    uint64_t timestamp = block.header.base_timestamp;
+    size_t lines = 0;
+
+    for (uint32_t i = 0; i < block.header.record_count && ptr < end; ++i) {
+        uint64_t id;
+        uint64_t delta;
+        uint64_t payload_size;
+        if (!binlog::getVarint(ptr, end, id) || ptr >= end) {
+            break;
+        }
+        const LogLevel level = static_cast<LogLevel>(*ptr++);
+        if (!binlog::getVarint(ptr, end, delta) || !binlog::getVarint(ptr, end, payload_size) ||
+            static_cast<uint64_t>(end - ptr) < payload_size) {
+            break;
+        }
+        timestamp += static_cast<uint64_t>(binlog::zigzagDecode(delta));
+        const char* payload = ptr;
+        ptr += payload_size;
+
+        if (id >= formats_.size() || !filter.acceptsLevel(level) ||
+            timestamp < filter.from || timestamp > filter.to) {
+            continue;
+        }
+
+        const Format& format = formats_[id];
+        const char* payload_end = payload + payload_size;
+        if (json) {
+            out += "{\"ts\":\"";
+            formatter.append(timestamp, out);
+            out += "\",\"level\":\"";
+            out += levelName(level);
+            out += "\",";
+            appendJson(format, payload, payload_end, out);
+            out += "}\n";
+        } else {
+            out += levelTag(level);
+            formatter.append(timestamp, out);
+            out += ' ';
+            appendText(format, payload, payload_end, out);
+            out += '\n';
+        }
+        ++lines;
+    }
+    return lines;
+}
+
+bool BinaryLogReader::appendText(const Format& format, const char* payload, const char* end, std::string& out) {
+    const size_t message_args = format.segments.size() - 1;
+    out += format.segments[0];
+    for (size_t arg = 0; arg < message_args; ++arg) {
+        if ((payload = appendArg(format.arg_types[arg], payload, end, out)) == nullptr) {
+            return false;
+        }
+        out += format.segments[arg + 1];
+    }
+    for (size_t field = 0; field < format.fields.size(); ++field) {
+        const ArgType type = format.arg_types[message_args + field];
+        out += ' ';
+        out += format.fields[field];
+        out += '=';
+        const size_t start = out.size();
+        if ((payload = appendArg(type, payload, end, out)) == nullptr) {
+            return false;
+        }
+        finishTextValue(type, out, start);
+    }
+    return true;
+}
+
+bool BinaryLogReader::appendJson(const Format& format, const char* payload, const char* end, std::string& out) {
+    const size_t message_args = format.segments.size() - 1;
+    out += "\"msg\":\"";
+    const size_t message_start = out.size();
+    out += format.segments[0];
+    bool complete = true;
+    for (size_t arg = 0; arg < message_args && complete; ++arg) {
+        complete = (payload = appendArg(format.arg_types[arg], payload, end, out)) != nullptr;
+        out += format.segments[arg + 1];
+    }
+    escapeJson(out, message_start);
+    out += '"';
+    for (size_t field = 0; field < format.fields.size() && complete; ++field) {
+        const ArgType type = format.arg_types[message_args + field];
+        out += ",\"";
+        out += format.fields[field];
+        out += "\":";
+        const size_t start = out.size();
+        if ((payload = appendArg(type, payload, end, out)) == nullptr) {
+            out += "null";
+            return false;
+        }
+        finishJsonValue(type, out, start);
+    }
+    return complete;
+}
+
+namespace {
+
+template<typename T>
+const char* decodeValue(const char* ptr, const char* end, std::string& out) {
+    if (static_cast<size_t>(end - ptr) < sizeof(T)) {
+        return nullptr;
+    }
+    T value;
+    std::memcpy(&value, ptr, sizeof(T));
+    appendValue(out, value);
+    return ptr + sizeof(T);
+}
+
+} // namespace
+
+const char* BinaryLogReader::appendArg(ArgType type, const char* ptr, const char* end, std::string& out) {
+    switch (type) {
+        case ArgType::Bool:
+            return decodeValue<bool>(ptr, end, out);
+        case ArgType::Char:
+            return decodeValue<char>(ptr, end, out);
+        case ArgType::Int16:
+            return decodeValue<int16_t>(ptr, end, out);
+        case ArgType::UInt16:
+            return decodeValue<uint16_t>(ptr, end, out);
+        case ArgType::Int32:
+            return decodeValue<int32_t>(ptr, end, out);
+        case ArgType::UInt32:
+            return decodeValue<uint32_t>(ptr, end, out);
+        case ArgType::Int64:
+            return decodeValue<int64_t>(ptr, end, out);
+        case ArgType::UInt64:
+            return decodeValue<uint64_t>(ptr, end, out);
+        case ArgType::Float:
+            return decodeValue<float>(ptr, end, out);
+        case ArgType::Double:
+            return decodeValue<double>(ptr, end, out);
+        case ArgType::LongDouble:
+            return decodeValue<long double>(ptr, end, out);
+        case ArgType::Pointer:
+            return decodeValue<const void*>(ptr, end, out);
+        case ArgType::String: {
+            uint32_t length;
+            if (static_cast<size_t>(end - ptr) < sizeof(length)) {
+                return nullptr;
+            }
+            std::memcpy(&length, ptr, sizeof(length));
+            ptr += sizeof(length);
+            if (static_cast<size_t>(end - ptr) < length) {
+                return nullptr;
+            }
+            out.append(ptr, length);
+            return ptr + length;
+        }
+        case ArgType::None:
+            break;
+    }
+    return nullptr;
+}
@@ -0,0 +1,100 @@
+#include "binary_log_writer.h"
+#include "binary_log_format.h"
+#include <cstring>
+#include <string_view>
+
+void BinaryLogWriter::append(const RecordHeader& header, uint64_t nanos, const char* payload) {
+    const uint32_t id = siteId(header.site);
+    if (last_block_[id] != block_number_) {
+        last_block_[id] = block_number_;
+        block_ids_.push_back(id);
+    }
+
+    if (record_count_ == 0) {
+        base_timestamp_ = previous_timestamp_ = min_timestamp_ = max_timestamp_ = nanos;
+    }
+    min_timestamp_ = nanos < min_timestamp_ ? nanos : min_timestamp_;
+    max_timestamp_ = nanos > max_timestamp_ ? nanos : max_timestamp_;
+
+    binlog::putVarint(records_, id);
+    records_ += static_cast<char>(header.level);
+    binlog::putVarint(records_, binlog::zigzagEncode(static_cast<int64_t>(nanos - previous_timestamp_)));
+    binlog::putVarint(records_, header.payload_size);
+    records_.append(payload, header.payload_size);
+
+    previous_timestamp_ = nanos;
+    ++record_count_;
+}
+
+void BinaryLogWriter::writeBlock(RotatingFile& file) {
+    if (record_count_ == 0) {
+        return;
+    }
+    file.rotateIfNeeded();
+
+    head_.clear();
+    if (file.currentSize() == 0) {
+        binlog::FileHeader file_header;
+        std::memcpy(file_header.magic, binlog::kFileMagic, sizeof(file_header.magic));
+        file_header.version = binlog::kFileVersion;
+        head_.append(reinterpret_cast<const char*>(&file_header), sizeof(file_header));
+    }
+
+    dict_.clear();
+    for (uint32_t id : block_ids_) {
+        if (written_generation_[id] != file.generation()) {
+            appendDictEntry(id);
+            written_generation_[id] = file.generation();
+        }
+    }
+
+    binlog::BlockHeader block;
+    block.magic = binlog::kBlockMagic;
+    block.record_count = record_count_;
+    block.dict_size = static_cast<uint32_t>(dict_.size());
+    block.records_size = static_cast<uint32_t>(records_.size());
+    block.base_timestamp = base_timestamp_;
+    block.min_timestamp = min_timestamp_;
+    block.max_timestamp = max_timestamp_;
+    head_.append(reinterpret_cast<const char*>(&block), sizeof(block));
+
+    const std::string_view parts[] = {head_, dict_, records_};
+    file.write(parts, 3);
+
+    records_.clear();
+    block_ids_.clear();
+    record_count_ = 0;
+    ++block_number_;
+}
+
+uint32_t BinaryLogWriter::siteId(const CallSiteInfo* site) {
+    auto it = ids_.find(site);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    const uint32_t id = static_cast<uint32_t>(sites_.size());
+    ids_.emplace(site, id);
+    sites_.push_back(site);
+    written_generation_.push_back(0);
+    last_block_.push_back(0);
+    return id;
+}
+
+void BinaryLogWriter::appendDictEntry(uint32_t id) {
+    const CallSiteInfo* site = sites_[id];
+    const size_t arg_count = site->segment_count - 1 + site->field_count;
+    binlog::putVarint(dict_, id);
+    dict_ += static_cast<char>(arg_count);
+    for (size_t i = 0; i < arg_count; ++i) {
+        dict_ += static_cast<char>(site->arg_types[i]);
+    }
+    const size_t length = std::strlen(site->format);
+    binlog::putVarint(dict_, length);
+    dict_.append(site->format, length);
+    dict_ += static_cast<char>(site->field_count);
+    for (size_t i = 0; i < site->field_count; ++i) {
+        const size_t key_length = std::strlen(site->field_names[i]);
+        binlog::putVarint(dict_, key_length);
+        dict_.append(site->field_names[i], key_length);
+    }
+}
@@ -0,0 +1,184 @@
+#include "compression_worker.h"
+#include "log_index.h"
+#include <iostream>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#ifdef LOGPRO_WITH_ZSTD
+#include "file_compressor.h"
+#include "stream_compressor.h"
+#endif
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#include <sys/qos.h>
+#endif
+
+CompressionWorker::CompressionWorker(int compression_level, size_t max_concurrency, size_t max_pending)
+    : compression_level_(compression_level)
+    , max_pending_(max_pending == 0 ? 1 : max_pending) {
+    if (max_concurrency == 0) {
+        max_concurrency = 1;
+    }
+    for (size_t i = 0; i < max_concurrency; ++i) {
+        workers_.emplace_back(&CompressionWorker::run, this);
+    }
+}
+
+CompressionWorker::~CompressionWorker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_shutdown_ = true;
+    }
+    cond_var_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+bool CompressionWorker::submit(const std::string& segment_path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (is_shutdown_ || pending_.size() >= max_pending_) {
+            return false;
+        }
+        pending_.push_back(segment_path);
+    }
+    cond_var_.notify_one();
+    return true;
+}
+
+bool CompressionWorker::isSupported() {
+#ifdef LOGPRO_WITH_ZSTD
+    return true;
+#else
+    return false;
+#endif
+}
+
+void CompressionWorker::run() {
+    lowerThreadPriority();
+    for (;;) {
+        std::string segment_path;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_var_.wait(lock, [this]() {
+                return !pending_.empty() || is_shutdown_;
+            });
+            // 退出前把已提交的段压缩完，避免留下半成品
+            if (pending_.empty()) {
+                return;
+            }
+            segment_path = pending_.front();
+            pending_.pop_front();
+        }
+        if (!compressSegment(segment_path)) {
+            std::cerr << "日志段压缩失败，保留原文件: " << segment_path << std::endl;
+        }
+    }
+}
+
+bool CompressionWorker::compressSegment(const std::string& segment_path) {
+#ifdef LOGPRO_WITH_ZSTD
+    const std::string compressed_path = segment_path + ".zst";
+    if (std::filesystem::exists(logindex::indexPath(segment_path))) {
+        if (!compressIndexedSegment(segment_path, compressed_path)) {
+            std::remove(compressed_path.c_str());
+            std::remove(logindex::indexPath(compressed_path).c_str());
+            return false;
+        }
+        std::remove(logindex::indexPath(segment_path).c_str());
+        return std::remove(segment_path.c_str()) == 0;
+    }
+    if (!zstd_compressor::FileCompressor::compress(segment_path, compressed_path, compression_level_)) {
+        std::remove(compressed_path.c_str());
+        return false;
+    }
+    return std::remove(segment_path.c_str()) == 0;
+#else
+    (void)segment_path;
+    return false;
+#endif
+}
+
+bool CompressionWorker::compressIndexedSegment(const std::string& segment_path, const std::string& compressed_path) {
+#ifdef LOGPRO_WITH_ZSTD
+    uint32_t flags = 0;
+    std::vector<logindex::IndexEntry> entries;
+    if (!logindex::readIndexFile(logindex::indexPath(segment_path), flags, entries)) {
+        return false;
+    }
+    std::ifstream in(segment_path, std::ios::binary);
+    std::ofstream out(compressed_path, std::ios::binary | std::ios::trunc);
+    if (!in || !out) {
+        return false;
+    }
+    in.seekg(0, std::ios::end);
+    const uint64_t segment_size = static_cast<uint64_t>(in.tellg());
+
+    // 索引没有覆盖到的部分（条目之间的空隙、最后一段）也各自成帧，在新索引中标记为全范围
+    std::vector<logindex::IndexEntry> chunks;
+    uint64_t position = 0;
+    auto addGap = [&](uint64_t end) {
+        if (end > position) {
+            chunks.push_back({position, end - position, 0, ~static_cast<uint64_t>(0), ~0u, 0});
+        }
+    };
+    for (const auto& entry : entries) {
+        if (entry.offset < position || entry.offset + entry.size > segment_size) {
+            break;
+        }
+        addGap(entry.offset);
+        chunks.push_back(entry);
+        position = entry.offset + entry.size;
+    }
+    addGap(segment_size);
+
+    zstd_compressor::StreamCompressor compressor(compression_level_);
+    std::vector<char> buffer;
+    uint64_t compressed_offset = 0;
+    for (auto& chunk : chunks) {
+        buffer.resize(chunk.size);
+        in.seekg(static_cast<std::streamoff>(chunk.offset));
+        if (!in.read(buffer.data(), static_cast<std::streamsize>(chunk.size))) {
+            return false;
+        }
+        std::vector<char> frame = compressor.compress(buffer.data(), buffer.size());
+        if (frame.empty()) {
+            return false;
+        }
+        out.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+        chunk.offset = compressed_offset;
+        chunk.size = frame.size();
+        compressed_offset += frame.size();
+    }
+    out.close();
+    return static_cast<bool>(out) &&
+           logindex::writeIndexFile(logindex::indexPath(compressed_path), logindex::kCompressedFrames, chunks);
+#else
+    (void)segment_path;
+    (void)compressed_path;
+    return false;
+#endif
+}
+
+void CompressionWorker::lowerThreadPriority() {
+#if defined(__linux__)
+    // SCHED_IDLE 只在 CPU 空闲时调度，nice 值作为不支持时的兜底
+    sched_param param{};
+    param.sched_priority = 0;
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+#elif defined(__APPLE__)
+    pthread_set_qos_class_self_np(QOS_CLASS_BACKGROUND, 0);
+#endif
+}
@@ -0,0 +1,138 @@
+#include "log_clock.h"
+#include <ctime>
+#include <thread>
+
+namespace {
+
+struct TscCalibration {
+    double nanos_per_tick = 1.0;
+};
+
+// 每个进程只校准一次：在 system_clock 上对比一小段时间内的计数增量
+const TscCalibration& tscCalibration() {
+    static const TscCalibration calibration = []() {
+        TscCalibration result;
+        if (!LogClock::tscSupported()) {
+            return result;
+        }
+        const uint64_t nanos_begin = LogClock::systemNanos();
+        const uint64_t ticks_begin = LogClock::readTsc();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const uint64_t nanos_end = LogClock::systemNanos();
+        const uint64_t ticks_end = LogClock::readTsc();
+        if (ticks_end > ticks_begin) {
+            result.nanos_per_tick = static_cast<double>(nanos_end - nanos_begin) /
+                                    static_cast<double>(ticks_end - ticks_begin);
+        }
+        return result;
+    }();
+    return calibration;
+}
+
+} // namespace
+
+LogClock::LogClock(ClockSource source)
+    : source_(source == ClockSource::Tsc && !tscSupported() ? ClockSource::System : source) {
+    if (source_ == ClockSource::Tsc) {
+        const double nanos_per_tick = tscCalibration().nanos_per_tick;
+        sample(origin_ticks_, origin_nanos_);
+        base_ticks_.store(origin_ticks_, std::memory_order_relaxed);
+        base_nanos_.store(origin_nanos_, std::memory_order_relaxed);
+        nanos_per_tick_.store(nanos_per_tick, std::memory_order_relaxed);
+        const double interval = std::chrono::duration<double, std::nano>(kRecalibrationInterval).count();
+        next_recalibration_.store(origin_ticks_ + static_cast<uint64_t>(interval / nanos_per_tick),
+                                  std::memory_order_relaxed);
+    }
+}
+
+uint64_t LogClock::toNanos(uint64_t ticks) const {
+    if (source_ == ClockSource::System) {
+        return ticks;
+    }
+    uint64_t base_ticks;
+    uint64_t base_nanos;
+    double nanos_per_tick;
+    uint32_t before;
+    do {
+        before = sequence_.load(std::memory_order_acquire);
+        base_ticks = base_ticks_.load(std::memory_order_relaxed);
+        base_nanos = base_nanos_.load(std::memory_order_relaxed);
+        nanos_per_tick = nanos_per_tick_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((before & 1) != 0 || before != sequence_.load(std::memory_order_relaxed));
+
+    const double delta = static_cast<double>(static_cast<int64_t>(ticks - base_ticks)) * nanos_per_tick;
+    return base_nanos + static_cast<int64_t>(delta);
+}
+
+void LogClock::recalibrate() {
+    if (source_ != ClockSource::Tsc || readTsc() < next_recalibration_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    bool expected = false;
+    if (!recalibrating_.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+        return;
+    }
+
+    uint64_t ticks;
+    uint64_t nanos;
+    sample(ticks, nanos);
+    double nanos_per_tick = nanos_per_tick_.load(std::memory_order_relaxed);
+    if (ticks > origin_ticks_ && nanos > origin_nanos_) {
+        // 窗口越长，读数抖动和墙上时间调整对速率的影响越小
+        nanos_per_tick = static_cast<double>(nanos - origin_nanos_) / static_cast<double>(ticks - origin_ticks_);
+    }
+
+    const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    base_ticks_.store(ticks, std::memory_order_relaxed);
+    base_nanos_.store(nanos, std::memory_order_relaxed);
+    nanos_per_tick_.store(nanos_per_tick, std::memory_order_relaxed);
+    sequence_.store(sequence + 2, std::memory_order_release);
+
+    const double interval = std::chrono::duration<double, std::nano>(kRecalibrationInterval).count();
+    next_recalibration_.store(ticks + static_cast<uint64_t>(interval / nanos_per_tick), std::memory_order_relaxed);
+    recalibrating_.store(false, std::memory_order_release);
+}
+
+void LogClock::sample(uint64_t& ticks, uint64_t& nanos) {
+    const uint64_t before = readTsc();
+    nanos = systemNanos();
+    const uint64_t after = readTsc();
+    ticks = before + (after - before) / 2;
+}
+
+bool LogClock::tscSupported() {
+#if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void TimestampFormatter::append(uint64_t nanos, std::string& out) {
+    const int64_t second = static_cast<int64_t>(nanos / 1000000000ULL);
+    if (second != cached_second_) {
+        std::time_t time = static_cast<std::time_t>(second);
+        std::tm tm_buf;
+        localtime_r(&time, &tm_buf);
+        prefix_length_ = std::strftime(prefix_, sizeof(prefix_), "%Y-%m-%d %H:%M:%S", &tm_buf);
+        cached_second_ = second;
+    }
+    out.append(prefix_, prefix_length_);
+
+    uint32_t fraction = static_cast<uint32_t>(nanos % 1000000000ULL);
+    int digits = 9;
+    if (precision_ == TimestampPrecision::Micro) {
+        fraction /= 1000;
+        digits = 6;
+    }
+    char buffer[10];
+    buffer[0] = '.';
+    for (int i = digits; i > 0; --i) {
+        buffer[i] = static_cast<char>('0' + fraction % 10);
+        fraction /= 10;
+    }
+    out.append(buffer, digits + 1);
+}
@@ -0,0 +1,102 @@
+#include "log_fields.h"
+#include "log_record.h"
+
+namespace {
+
+// 一个字符转义后的长度
+size_t escapedLength(unsigned char c) {
+    switch (c) {
+        case '"':
+        case '\\':
+        case '\n':
+        case '\r':
+        case '\t':
+        case '\b':
+        case '\f':
+            return 2;
+        default:
+            return c < 0x20 ? 6 : 1;
+    }
+}
+
+void quote(std::string& out, size_t start) {
+    escapeJson(out, start);
+    out.insert(out.begin() + static_cast<std::ptrdiff_t>(start), '"');
+    out += '"';
+}
+
+} // namespace
+
+void escapeJson(std::string& out, size_t start) {
+    size_t extra = 0;
+    for (size_t i = start; i < out.size(); ++i) {
+        extra += escapedLength(static_cast<unsigned char>(out[i])) - 1;
+    }
+    if (extra == 0) {
+        return;
+    }
+
+    // 从后往前原地展开，不需要临时字符串
+    size_t src = out.size();
+    out.resize(out.size() + extra);
+    size_t dst = out.size();
+    static constexpr char kHex[] = "0123456789abcdef";
+    while (src > start) {
+        const unsigned char c = static_cast<unsigned char>(out[--src]);
+        const size_t length = escapedLength(c);
+        if (length == 1) {
+            out[--dst] = static_cast<char>(c);
+            continue;
+        }
+        dst -= length;
+        out[dst] = '\\';
+        switch (c) {
+            case '"': out[dst + 1] = '"'; break;
+            case '\\': out[dst + 1] = '\\'; break;
+            case '\n': out[dst + 1] = 'n'; break;
+            case '\r': out[dst + 1] = 'r'; break;
+            case '\t': out[dst + 1] = 't'; break;
+            case '\b': out[dst + 1] = 'b'; break;
+            case '\f': out[dst + 1] = 'f'; break;
+            default:
+                out[dst + 1] = 'u';
+                out[dst + 2] = '0';
+                out[dst + 3] = '0';
+                out[dst + 4] = kHex[c >> 4];
+                out[dst + 5] = kHex[c & 0xF];
+                break;
+        }
+    }
+}
+
+void finishJsonValue(ArgType type, std::string& out, size_t start) {
+    switch (type) {
+        case ArgType::String:
+        case ArgType::Char:
+        case ArgType::Pointer:
+            quote(out, start);
+            return;
+        case ArgType::Bool:
+            out.replace(start, std::string::npos, out.compare(start, std::string::npos, "1") == 0 ? "true" : "false");
+            return;
+        case ArgType::Float:
+        case ArgType::Double:
+        case ArgType::LongDouble:
+            // 有限数值只含数字、符号、小数点和指数
+            if (out.find_first_of("ain", start) != std::string::npos) {
+                quote(out, start);
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+void finishTextValue(ArgType type, std::string& out, size_t start) {
+    if (type != ArgType::String && type != ArgType::Char) {
+        return;
+    }
+    if (out.size() == start || out.find_first_of(" \"=\n", start) != std::string::npos) {
+        quote(out, start);
+    }
+}
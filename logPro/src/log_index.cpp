@@ -0,0 +1,202 @@
+#include "log_index.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef LOGPRO_WITH_ZSTD
+#include "stream_compressor.h"
+#endif
+
+namespace logindex {
+
+bool readIndexFile(const std::string& path, uint32_t& flags, std::vector<IndexEntry>& entries) {
+    std::ifstream in(path, std::ios::binary);
+    IndexFileHeader header;
+    if (!in || !in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kFileMagic, sizeof(header.magic)) != 0 || header.version != kFileVersion) {
+        return false;
+    }
+    flags = header.flags;
+    entries.clear();
+    IndexEntry entry;
+    while (in.read(reinterpret_cast<char*>(&entry), sizeof(entry))) {
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+bool writeIndexFile(const std::string& path, uint32_t flags, const std::vector<IndexEntry>& entries) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    IndexFileHeader header{};
+    std::memcpy(header.magic, kFileMagic, sizeof(header.magic));
+    header.version = kFileVersion;
+    header.flags = flags;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              static_cast<std::streamsize>(entries.size() * sizeof(IndexEntry)));
+    return static_cast<bool>(out);
+}
+
+} // namespace logindex
+
+IndexedLogReader::~IndexedLogReader() {
+    if (mapping_ != nullptr) {
+        munmap(mapping_, size_);
+    }
+}
+
+bool IndexedLogReader::open(const std::string& path) {
+    compressed_ = path.size() > 4 && path.compare(path.size() - 4, 4, ".zst") == 0;
+#ifndef LOGPRO_WITH_ZSTD
+    if (compressed_) {
+        error_ = "未编译 zstd 支持，无法读取: " + path;
+        return false;
+    }
+#endif
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error_ = "无法打开文件: " + path;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        error_ = "无法读取文件信息: " + path;
+        return false;
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+        mapping_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        error_ = "无法映射文件: " + path;
+        return false;
+    }
+
+    uint32_t flags = 0;
+    std::vector<logindex::IndexEntry> entries;
+    if (!logindex::readIndexFile(logindex::indexPath(path), flags, entries) ||
+        ((flags & logindex::kCompressedFrames) != 0) != compressed_) {
+        entries.clear();
+    }
+    buildChunks(entries);
+    return true;
+}
+
+void IndexedLogReader::buildChunks(const std::vector<logindex::IndexEntry>& entries) {
+    // 索引条目按写入顺序排列；条目之间和末尾没有覆盖到的部分作为未索引块
+    IndexRange unknown;
+    unknown.min_timestamp = 0;
+    unknown.max_timestamp = ~static_cast<uint64_t>(0);
+    unknown.level_mask = ~0u;
+
+    uint64_t position = 0;
+    for (const auto& entry : entries) {
+        if (entry.offset < position || entry.offset + entry.size > size_) {
+            break;
+        }
+        if (entry.offset > position) {
+            chunks_.push_back({position, entry.offset - position, unknown, false});
+        }
+        // 压缩时为未索引部分补的帧带有全范围，仍按未索引块处理
+        const bool indexed = entry.min_timestamp != 0 || entry.max_timestamp != ~static_cast<uint64_t>(0);
+        chunks_.push_back({entry.offset, entry.size,
+                           IndexRange{entry.min_timestamp, entry.max_timestamp, entry.level_mask}, indexed});
+        position = entry.offset + entry.size;
+    }
+    if (position < size_) {
+        chunks_.push_back({position, size_ - position, unknown, false});
+    }
+
+    // 未索引块不参与前缀/后缀计算，由 select() 单独保留
+    prefix_max_.resize(chunks_.size());
+    suffix_min_.resize(chunks_.size());
+    uint64_t running_max = 0;
+    for (size_t i = 0; i < chunks_.size(); ++i) {
+        if (chunks_[i].indexed) {
+            running_max = std::max(running_max, chunks_[i].range.max_timestamp);
+        }
+        prefix_max_[i] = running_max;
+    }
+    uint64_t running_min = ~static_cast<uint64_t>(0);
+    for (size_t i = chunks_.size(); i > 0; --i) {
+        if (chunks_[i - 1].indexed) {
+            running_min = std::min(running_min, chunks_[i - 1].range.min_timestamp);
+        }
+        suffix_min_[i - 1] = running_min;
+    }
+}
+
+uint64_t IndexedLogReader::firstTimestamp() const {
+    uint64_t first = ~static_cast<uint64_t>(0);
+    for (const auto& chunk : chunks_) {
+        if (chunk.indexed) {
+            first = std::min(first, chunk.range.min_timestamp);
+        }
+    }
+    return first == ~static_cast<uint64_t>(0) ? 0 : first;
+}
+
+std::vector<size_t> IndexedLogReader::select(uint64_t from, uint64_t to, uint32_t level_mask) const {
+    // 日志基本按时间顺序写出，前缀最大值单调不减：它小于 from 的块都可以跳过
+    const size_t start = static_cast<size_t>(
+        std::partition_point(prefix_max_.begin(), prefix_max_.end(),
+                             [from](uint64_t max) { return max < from; }) - prefix_max_.begin());
+
+    std::vector<size_t> selected;
+    for (size_t i = 0; i < chunks_.size(); ++i) {
+        const Chunk& chunk = chunks_[i];
+        if (!chunk.indexed) {
+            selected.push_back(i);
+            continue;
+        }
+        if (i < start) {
+            continue;
+        }
+        if (suffix_min_[i] > to) {
+            // 之后的已索引块都晚于 to，只剩可能存在的未索引块
+            for (size_t j = i + 1; j < chunks_.size(); ++j) {
+                if (!chunks_[j].indexed) {
+                    selected.push_back(j);
+                }
+            }
+            break;
+        }
+        if (chunk.range.max_timestamp >= from && chunk.range.min_timestamp <= to &&
+            (chunk.range.level_mask & level_mask) != 0) {
+            selected.push_back(i);
+        }
+    }
+    return selected;
+}
+
+bool IndexedLogReader::read(const Chunk& chunk, std::string& buffer, std::string_view& text) const {
+    const char* data = static_cast<const char*>(mapping_) + chunk.offset;
+    if (!compressed_) {
+        text = std::string_view(data, chunk.size);
+        return true;
+    }
+#ifdef LOGPRO_WITH_ZSTD
+    zstd_compressor::StreamCompressor decompressor;
+    std::vector<char> decoded = decompressor.decompress(data, chunk.size);
+    if (decoded.empty() && chunk.size > 0) {
+        return false;
+    }
+    buffer.assign(decoded.data(), decoded.size());
+    text = buffer;
+    return true;
+#else
+    (void)buffer;
+    (void)text;
+    return false;
+#endif
+}
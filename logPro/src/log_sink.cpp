@@ -0,0 +1,91 @@
+#include "log_sink.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+void LogSink::write(const LogBatch& batch) {
+    if (accepts(LogLevel::DEBUG) || batch.lines.empty()) {
+        writeText(batch.text);
+        return;
+    }
+    if (!accepts(batch.max_level)) {
+        return;
+    }
+
+    // 把相邻的、都通过过滤的行合并成一次 writeText
+    size_t run_begin = 0;
+    size_t run_end = 0;
+    for (const auto& line : batch.lines) {
+        if (!accepts(line.level)) {
+            continue;
+        }
+        if (line.offset != run_end) {
+            if (run_end > run_begin) {
+                writeText(std::string_view(batch.text).substr(run_begin, run_end - run_begin));
+            }
+            run_begin = line.offset;
+        }
+        run_end = line.offset + line.length;
+    }
+    if (run_end > run_begin) {
+        writeText(std::string_view(batch.text).substr(run_begin, run_end - run_begin));
+    }
+}
+
+void ConsoleSink::writeText(std::string_view text) {
+    std::fwrite(text.data(), 1, text.size(), stream_);
+}
+
+void ConsoleSink::flush() {
+    std::fflush(stream_);
+}
+
+void FileSink::writeText(std::string_view text) {
+    file_.rotateIfNeeded();
+    file_.write(text);
+}
+
+MemoryRingSink::MemoryRingSink(size_t capacity, LogLevel level)
+    : LogSink(level)
+    , buffer_(capacity == 0 ? 1 : capacity) {}
+
+void MemoryRingSink::writeText(std::string_view text) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t capacity = buffer_.size();
+    if (text.size() >= capacity) {
+        text = text.substr(text.size() - capacity);
+    }
+    const size_t first = std::min(text.size(), capacity - head_);
+    std::memcpy(buffer_.data() + head_, text.data(), first);
+    std::memcpy(buffer_.data(), text.data() + first, text.size() - first);
+    if (head_ + text.size() >= capacity) {
+        wrapped_ = true;
+    }
+    head_ = (head_ + text.size()) % capacity;
+}
+
+std::string MemoryRingSink::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!wrapped_) {
+        return std::string(buffer_.data(), head_);
+    }
+    std::string result(buffer_.data() + head_, buffer_.size() - head_);
+    result.append(buffer_.data(), head_);
+    // 最旧的一行可能已被部分覆盖
+    size_t newline = result.find('\n');
+    if (newline != std::string::npos) {
+        result.erase(0, newline + 1);
+    }
+    return result;
+}
+
+void MemoryRingSink::dump(int fd) const {
+    const size_t head = head_;
+    if (wrapped_) {
+        ssize_t ignored = ::write(fd, buffer_.data() + head, buffer_.size() - head);
+        (void)ignored;
+    }
+    ssize_t ignored = ::write(fd, buffer_.data(), head);
+    (void)ignored;
+}
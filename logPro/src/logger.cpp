@@ -0,0 +1,674 @@
+#include "logger.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+
+std::atomic<uint64_t> g_next_logger_id{1};
+
+// 持有本线程注册过的所有暂存缓冲区，线程退出时标记为 retired，
+// 由后台线程取空后回收
+struct ThreadStagingOwner {
+    std::vector<std::pair<uint64_t, std::shared_ptr<StagingBuffer>>> buffers;
+
+    ~ThreadStagingOwner() {
+        for (auto& entry : buffers) {
+            entry.second->retired.store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadStagingOwner t_staging_owner;
+
+// 持有本线程在各 Logger 中的计数块，线程退出时标记为 retired
+struct ThreadMetricsOwner {
+    std::vector<std::pair<uint64_t, std::shared_ptr<ProducerMetrics>>> metrics;
+
+    ~ThreadMetricsOwner() {
+        for (auto& entry : metrics) {
+            entry.second->retired.store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadMetricsOwner t_metrics_owner;
+
+uint64_t elapsedNanos(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count());
+}
+
+// 后台线程空闲时的轮询间隔，PerThread 模式下生产者不发送唤醒信号
+constexpr auto kStagingIdleSleep = std::chrono::microseconds(200);
+
+// 共享内存环写满时最多等待收集器这么久，超时后丢弃本批剩余的行
+constexpr auto kShmFullTimeout = std::chrono::seconds(1);
+
+// 后台线程为限流调用点输出压制汇总的间隔
+constexpr auto kSuppressedReportInterval = std::chrono::seconds(1);
+
+// 持续高负载时取队列的循环不会结束，每取出这么多条就更新一次写出计数和队列深度峰值
+constexpr size_t kMetricsUpdateInterval = 1024;
+
+} // namespace
+
+std::string shardFileName(const std::string& filename, size_t shard, size_t shard_count) {
+    if (shard_count <= 1) {
+        return filename;
+    }
+    std::filesystem::path path(filename);
+    return (path.parent_path() / path.stem()).string() + "." + std::to_string(shard) +
+           path.extension().string();
+}
+
+Logger::Shard::Shard(size_t index, const std::string& filename, const LoggerOptions& options, DropCounter* drops)
+    : index(index)
+    , log_queue(options.queue_mode == QueueMode::Shared ? options.queue_capacity : 2, options.overflow, drops)
+    , timestamp_formatter(options.timestamp_precision)
+    , last_write(std::chrono::steady_clock::now()) {
+    // 二进制格式依赖文件内的格式字典，只能写本地文件
+    if (!options.shm_channel.empty() && options.format != LogFormat::Binary) {
+        shm_ring = std::make_unique<ShmLogRing>();
+        if (!shm_ring->create(shmlog::segmentName(options.shm_channel, static_cast<int>(getpid()), index),
+                              options.shm_ring_size)) {
+            std::cerr << shm_ring->error() << "，改为写本地文件" << std::endl;
+            shm_ring.reset();
+        }
+    }
+    if (shm_ring == nullptr) {
+        log_file = std::make_unique<RotatingFile>(filename, options.rotation, options.file_write_mode,
+                                                  options.mmap_segment_size,
+                                                  options.format == LogFormat::Text ? options.index_interval : 0);
+    }
+    batch = std::make_shared<LogBatch>();
+    batch->text.reserve(options.write_buffer_size + 4096);
+    batch_pool.push_back(batch);
+}
+
+Logger::Logger(const std::string& filename, const LoggerOptions& options)
+    : id_(g_next_logger_id.fetch_add(1, std::memory_order_relaxed))
+    , level_(options.level)
+    , queue_mode_(options.queue_mode)
+    , staging_buffer_size_(options.staging_buffer_size)
+    , format_(options.format)
+    , flush_policy_(options.flush_policy)
+    , flush_interval_(options.flush_interval)
+    , write_buffer_size_(options.write_buffer_size)
+    , clock_(options.clock_source)
+    , overflow_(options.overflow)
+    , collect_metrics_(options.collect_metrics)
+    , buffer_pool_(options.record_buffer_size, options.queue_mode == QueueMode::Shared
+                   ? options.record_pool_size * std::max<size_t>(1, options.backend_threads) : 0)
+    , exit_flag_(false) {
+    if (options.console_output) {
+        sink_channels_.push_back(std::make_unique<SinkChannel>(std::make_shared<ConsoleSink>()));
+    }
+    for (const auto& sink : options.sinks) {
+        sink_channels_.push_back(std::make_unique<SinkChannel>(sink));
+    }
+    const size_t shard_count = std::max<size_t>(1, options.backend_threads);
+    for (size_t i = 0; i < shard_count; ++i) {
+        auto shard = std::make_unique<Shard>(i, shardFileName(filename, i, shard_count), options, &drops_);
+        // 二进制文件的格式字典只对本进程有效，已有内容的文件先轮转出去再写
+        if (format_ == LogFormat::Binary && shard->log_file->currentSize() > 0) {
+            shard->log_file->rotate();
+        }
+        shards_.push_back(std::move(shard));
+    }
+    // 全部分片建好后再启动后台线程，生产者可能在任一线程启动后立即开始写日志
+    for (auto& shard : shards_) {
+        if (queue_mode_ == QueueMode::PerThread) {
+            shard->worker_thread = std::thread(&Logger::processStagingBuffers, this, std::ref(*shard));
+        } else {
+            shard->worker_thread = std::thread(&Logger::processQueue, this, std::ref(*shard));
+        }
+    }
+}
+
+Logger::~Logger() {
+    exit_flag_ = true;
+    for (auto& shard : shards_) {
+        shard->log_queue.shutdown();
+    }
+    for (auto& shard : shards_) {
+        if (shard->worker_thread.joinable()) {
+            shard->worker_thread.join();
+        }
+    }
+    // 等各输出目标写完已发布的批次
+    sink_channels_.clear();
+
+    // 调用点是静态变量，比 Logger 活得久：解除登记，之后可以登记到新的 Logger
+    for (RateLimiter* limiter = rate_limiters_.load(std::memory_order_acquire); limiter != nullptr;
+         limiter = limiter->next_registered) {
+        limiter->releaseRegistration();
+    }
+
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->staging_mutex);
+        for (auto& buffer : shard->staging_buffers) {
+            buffer->detached.store(true, std::memory_order_release);
+        }
+    }
+}
+
+void Logger::processQueue(Shard& shard) {
+    LogRecord record;
+    for (;;) {
+        // 先读退出标志再取数据：退出前入队的记录一定会在最后一轮被取走
+        const bool exiting = exit_flag_.load(std::memory_order_acquire);
+        clock_.recalibrate();
+
+        shard.max_queue_depth.raise(shard.log_queue.size());
+        size_t count = 0;
+        size_t unreported = 0;
+        while (shard.log_queue.tryPop(record)) {
+            appendRecord(shard, record.header, record.payload.data());
+            record.payload.reset();
+            ++count;
+            if (++unreported == kMetricsUpdateInterval) {
+                shard.records_written.add(unreported);
+                shard.max_queue_depth.raise(shard.log_queue.size());
+                unreported = 0;
+            }
+        }
+        shard.records_written.add(unreported);
+        reportDrops(shard, exiting && count == 0);
+        reportSuppressed(shard, exiting && count == 0);
+        endBatch(shard);
+
+        if (count > 0) {
+            continue;
+        }
+        if (exiting) {
+            break;
+        }
+        shard.log_queue.wait(idleWait(shard));
+    }
+    writeBatch(shard);
+}
+
+void Logger::processStagingBuffers(Shard& shard) {
+    std::vector<std::shared_ptr<StagingBuffer>> buffers;
+    uint64_t seen_version = ~static_cast<uint64_t>(0);
+    SpinWait spin;
+
+    for (;;) {
+        // 先读退出标志再取数据：退出前已提交的记录一定会在最后一轮被取走
+        const bool exiting = exit_flag_.load(std::memory_order_acquire);
+        clock_.recalibrate();
+
+        const uint64_t version = shard.staging_version.load(std::memory_order_acquire);
+        if (version != seen_version) {
+            std::lock_guard<std::mutex> lock(shard.staging_mutex);
+            buffers = shard.staging_buffers;
+            seen_version = version;
+        }
+
+        const size_t count = drainStagingBuffers(shard, buffers);
+        // 本轮处理的正是开始时各字节环中已提交的全部记录
+        shard.max_queue_depth.raise(count);
+        shard.records_written.add(count);
+        reportDrops(shard, exiting && count == 0);
+        reportSuppressed(shard, exiting && count == 0);
+        endBatch(shard);
+
+        if (count > 0) {
+            spin.reset();
+            continue;
+        }
+        if (exiting) {
+            break;
+        }
+        if (!spin.spinOnce()) {
+            releaseRetiredBuffers(shard);
+            std::this_thread::sleep_for(kStagingIdleSleep);
+        }
+    }
+    writeBatch(shard);
+}
+
+size_t Logger::drainStagingBuffers(Shard& shard, const std::vector<std::shared_ptr<StagingBuffer>>& buffers) {
+    // 先固定本轮每个缓冲区的可读范围，再按时间戳多路归并
+    for (auto& buffer : buffers) {
+        buffer->ring.refresh();
+    }
+
+    size_t count = 0;
+    for (;;) {
+        StagingBuffer* oldest = nullptr;
+        const char* oldest_record = nullptr;
+        size_t oldest_size = 0;
+        uint64_t oldest_timestamp = ~static_cast<uint64_t>(0);
+
+        for (auto& buffer : buffers) {
+            size_t size;
+            const char* record = buffer->ring.front(size);
+            if (record == nullptr) {
+                continue;
+            }
+            RecordHeader header;
+            std::memcpy(&header, record, sizeof(header));
+            if (oldest == nullptr || header.timestamp < oldest_timestamp) {
+                oldest = buffer.get();
+                oldest_record = record;
+                oldest_size = size;
+                oldest_timestamp = header.timestamp;
+            }
+        }
+        if (oldest == nullptr) {
+            return count;
+        }
+
+        RecordHeader header;
+        std::memcpy(&header, oldest_record, sizeof(header));
+        appendRecord(shard, header, oldest_record + sizeof(RecordHeader));
+        oldest->ring.pop(oldest_size);
+        ++count;
+    }
+}
+
+void Logger::appendRecord(Shard& shard, const RecordHeader& header, const char* payload) {
+    if (!shard.batch_open) {
+        shard.batch_open = true;
+        shard.batch_opened = std::chrono::steady_clock::now();
+    }
+    if (header.level == LogLevel::ERROR) {
+        shard.batch_has_error = true;
+    }
+    const uint64_t nanos = clock_.toNanos(header.timestamp);
+    if (format_ == LogFormat::Binary) {
+        shard.binary_writer.append(header, nanos, payload);
+        // 二进制文件不需要文本，只有额外输出目标时才渲染
+        if (sink_channels_.empty()) {
+            if (shard.binary_writer.pendingBytes() >= write_buffer_size_) {
+                writeBatch(shard);
+            }
+            return;
+        }
+    }
+
+    LogBatch& batch = *shard.batch;
+    std::string& text = batch.text;
+    const size_t offset = text.size();
+    if (format_ == LogFormat::Json) {
+        text += "{\"ts\":\"";
+        shard.timestamp_formatter.append(nanos, text);
+        text += "\",\"level\":\"";
+        text += levelName(header.level);
+        text += "\",";
+        header.site->json_fn(payload, text);
+        text += "}\n";
+    } else {
+        text += levelTag(header.level);
+        shard.timestamp_formatter.append(nanos, text);
+        text += ' ';
+        header.site->format_fn(payload, text);
+        text += '\n';
+    }
+    batch.lines.push_back({nanos, static_cast<uint32_t>(offset), static_cast<uint32_t>(text.size() - offset),
+                           header.level});
+    if (static_cast<int>(header.level) > static_cast<int>(batch.max_level)) {
+        batch.max_level = header.level;
+    }
+    if (text.size() >= write_buffer_size_ || shard.binary_writer.pendingBytes() >= write_buffer_size_) {
+        writeBatch(shard);
+    }
+}
+
+void Logger::reportDrops(Shard& shard, bool force) {
+    // 丢弃计数是全局的，只由 0 号分片汇总，避免重复报告
+    if (shard.index != 0) {
+        return;
+    }
+    const uint64_t total = drops_.total();
+    const bool pressure_cleared = total == last_round_drops_;
+    last_round_drops_ = total;
+    if (!pressure_cleared && !force) {
+        return;
+    }
+
+    uint64_t dropped = 0;
+    std::string detail;
+    for (size_t i = 0; i < kLogLevelCount; ++i) {
+        const LogLevel level = static_cast<LogLevel>(i);
+        const uint64_t count = drops_.count(level);
+        if (count == reported_drops_[i]) {
+            continue;
+        }
+        if (!detail.empty()) {
+            detail += ' ';
+        }
+        detail += levelName(level);
+        detail += '=';
+        detail += std::to_string(count - reported_drops_[i]);
+        dropped += count - reported_drops_[i];
+        reported_drops_[i] = count;
+    }
+    if (dropped == 0) {
+        return;
+    }
+
+    using Site = CallSite<"log queue overflow: dropped {} records ({})", uint64_t, std::string_view>;
+    using Codec = ArgCodec<uint64_t, std::string_view>;
+    RecordHeader header;
+    header.timestamp = clock_.now();
+    header.site = &Site::info;
+    header.payload_size = static_cast<uint32_t>(Codec::size(dropped, detail));
+    header.level = LogLevel::WARN;
+    std::string payload(header.payload_size, '\0');
+    Codec::encode(&payload[0], dropped, detail);
+    appendRecord(shard, header, payload.data());
+}
+
+void Logger::trackRateLimiter(RateLimiter& limiter, LogLevel level, std::string_view format) {
+    if (!limiter.claimRegistration()) {
+        return;
+    }
+    limiter.report_level = level;
+    limiter.report_format = format;
+    RateLimiter* head = rate_limiters_.load(std::memory_order_relaxed);
+    do {
+        limiter.next_registered = head;
+    } while (!rate_limiters_.compare_exchange_weak(head, &limiter, std::memory_order_release,
+                                                   std::memory_order_relaxed));
+}
+
+void Logger::reportSuppressed(Shard& shard, bool force) {
+    if (shard.index != 0) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (!force && now < next_suppressed_report_) {
+        return;
+    }
+    next_suppressed_report_ = now + kSuppressedReportInterval;
+
+    using Site = CallSite<"suppressed {} messages: {}", uint64_t, std::string_view>;
+    using Codec = ArgCodec<uint64_t, std::string_view>;
+    const uint64_t coarse = coarseNanos();
+    std::string payload;
+    for (RateLimiter* limiter = rate_limiters_.load(std::memory_order_acquire); limiter != nullptr;
+         limiter = limiter->next_registered) {
+        // 与放行时的汇总共用 last_report_，同一批压制只会输出一次
+        const uint64_t suppressed = limiter->takeSuppressed(coarse, force);
+        if (suppressed == 0) {
+            continue;
+        }
+        RecordHeader header;
+        header.timestamp = clock_.now();
+        header.site = &Site::info;
+        header.payload_size = static_cast<uint32_t>(Codec::size(suppressed, limiter->report_format));
+        header.level = limiter->report_level;
+        payload.assign(header.payload_size, '\0');
+        Codec::encode(&payload[0], suppressed, limiter->report_format);
+        appendRecord(shard, header, payload.data());
+    }
+}
+
+void Logger::endBatch(Shard& shard) {
+    if (flush_policy_ != FlushPolicy::Periodic ||
+        std::chrono::steady_clock::now() - shard.last_write >= flush_interval_) {
+        writeBatch(shard);
+    }
+}
+
+void Logger::writeBatch(Shard& shard) {
+    const auto start = std::chrono::steady_clock::now();
+    shard.last_write = start;
+    if (format_ == LogFormat::Binary) {
+        if (shard.binary_writer.empty()) {
+            return;
+        }
+        shard.binary_writer.writeBlock(*shard.log_file);
+    } else if (shard.batch->empty()) {
+        return;
+    } else if (shard.shm_ring != nullptr) {
+        shard.bytes_written.add(writeShm(shard));
+    } else {
+        shard.log_file->rotateIfNeeded();
+        shard.log_file->write(shard.batch->text);
+        reportIndexRanges(shard);
+    }
+    publishBatch(shard);
+    if (shard.batch_has_error && flush_policy_ == FlushPolicy::FsyncOnError && shard.log_file != nullptr) {
+        shard.log_file->sync();
+    }
+    shard.batch_has_error = false;
+
+    const auto end = std::chrono::steady_clock::now();
+    shard.flush_duration.record(elapsedNanos(start, end));
+    if (shard.batch_open) {
+        shard.write_lag.record(elapsedNanos(shard.batch_opened, end));
+        shard.batch_open = false;
+    }
+    shard.batches_written.add(1);
+    if (shard.log_file != nullptr) {
+        shard.bytes_written.add(shard.log_file->bytesWritten() - shard.bytes_written.load());
+    }
+}
+
+void Logger::reportIndexRanges(Shard& shard) {
+    RotatingFile& file = *shard.log_file;
+    const size_t interval = file.indexInterval();
+    if (interval == 0) {
+        return;
+    }
+    // 一批最多 write_buffer_size 字节，按行分成约 index_interval 字节的几段报告，
+    // 否则整批只对应一条索引，logquery 每次至少要读一整批
+    IndexRange range;
+    size_t bytes = 0;
+    size_t carried = file.indexChunkBytes();    // 上一批留在当前条目中的字节
+    for (const LogBatch::Line& line : shard.batch->lines) {
+        range.add(line.nanos, line.level);
+        bytes += line.length;
+        if (carried + bytes >= interval) {
+            file.addIndexRange(range, bytes);
+            range = IndexRange();
+            bytes = 0;
+            carried = 0;
+        }
+    }
+    file.addIndexRange(range);
+}
+
+size_t Logger::writeShm(Shard& shard) {
+    const LogBatch& batch = *shard.batch;
+    ShmLogRing& ring = *shard.shm_ring;
+    size_t bytes = 0;
+    for (size_t i = 0; i < batch.lines.size(); ++i) {
+        const LogBatch::Line& line = batch.lines[i];
+        const std::string_view text(batch.text.data() + line.offset, line.length);
+        bool appended = ring.append(line.nanos, line.level, text);
+        if (!appended && !shard.shm_stalled) {
+            // 先发布已写入的部分，让收集器尽快腾出空间
+            ring.publish();
+            OverflowBackoff backoff(std::chrono::duration_cast<std::chrono::microseconds>(kShmFullTimeout));
+            while (!(appended = ring.append(line.nanos, line.level, text)) && backoff.wait()) {
+            }
+        }
+        if (!appended) {
+            // 收集器没有在运行或跟不上：本批剩余的行计入丢弃
+            shard.shm_stalled = true;
+            for (; i < batch.lines.size(); ++i) {
+                drops_.add(batch.lines[i].level);
+            }
+            break;
+        }
+        shard.shm_stalled = false;
+        bytes += text.size();
+    }
+    ring.publish();
+    return bytes;
+}
+
+void Logger::publishBatch(Shard& shard) {
+    if (shard.batch->empty()) {
+        return;
+    }
+    if (sink_channels_.empty()) {
+        shard.batch->clear();
+        return;
+    }
+
+    std::shared_ptr<const LogBatch> published = shard.batch;
+    for (auto& channel : sink_channels_) {
+        channel->publish(published);
+    }
+    published.reset();
+
+    // 复用各目标都已写完的批次，避免每批重新分配缓冲区
+    shard.batch = nullptr;
+    for (auto& pooled : shard.batch_pool) {
+        if (pooled.use_count() == 1) {
+            // 与目标线程释放引用时的 release 配对，之后才能改写批次内容
+            std::atomic_thread_fence(std::memory_order_acquire);
+            shard.batch = pooled;
+            break;
+        }
+    }
+    if (shard.batch == nullptr) {
+        shard.batch = std::make_shared<LogBatch>();
+        shard.batch->text.reserve(write_buffer_size_ + 4096);
+        shard.batch_pool.push_back(shard.batch);
+    }
+    shard.batch->clear();
+}
+
+std::chrono::milliseconds Logger::idleWait(const Shard& shard) const {
+    // Periodic 模式下还有未写出的数据时，最多等到下一次定时写出
+    if (flush_policy_ == FlushPolicy::Periodic && (!shard.batch->empty() || !shard.binary_writer.empty())) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - shard.last_write);
+        return elapsed >= flush_interval_ ? std::chrono::milliseconds(1) : flush_interval_ - elapsed;
+    }
+    return std::chrono::milliseconds(100);
+}
+
+void Logger::releaseRetiredBuffers(Shard& shard) {
+    std::lock_guard<std::mutex> lock(shard.staging_mutex);
+    auto it = std::remove_if(shard.staging_buffers.begin(), shard.staging_buffers.end(),
+                             [](const std::shared_ptr<StagingBuffer>& buffer) {
+        return buffer->retired.load(std::memory_order_acquire) && buffer->ring.refresh() == 0;
+    });
+    if (it != shard.staging_buffers.end()) {
+        shard.staging_buffers.erase(it, shard.staging_buffers.end());
+        shard.staging_version.fetch_add(1, std::memory_order_release);
+    }
+}
+
+StagingBuffer* Logger::registerThread() {
+    auto& owned = t_staging_owner.buffers;
+
+    // 顺便释放已析构 Logger 的缓冲区
+    owned.erase(std::remove_if(owned.begin(), owned.end(),
+                               [](const std::pair<uint64_t, std::shared_ptr<StagingBuffer>>& entry) {
+        return entry.second->detached.load(std::memory_order_acquire);
+    }), owned.end());
+
+    StagingBuffer* buffer = nullptr;
+    for (auto& entry : owned) {
+        if (entry.first == id_) {
+            buffer = entry.second.get();
+            break;
+        }
+    }
+    if (buffer == nullptr) {
+        auto created = std::make_shared<StagingBuffer>(staging_buffer_size_);
+        Shard& shard = *shards_[next_staging_shard_.fetch_add(1, std::memory_order_relaxed) % shards_.size()];
+        {
+            std::lock_guard<std::mutex> lock(shard.staging_mutex);
+            shard.staging_buffers.push_back(created);
+            shard.staging_version.fetch_add(1, std::memory_order_release);
+        }
+        owned.emplace_back(id_, created);
+        buffer = created.get();
+    }
+
+    staging_slot_.logger_id = id_;
+    staging_slot_.buffer = buffer;
+    return buffer;
+}
+
+ProducerMetrics* Logger::registerMetrics() {
+    auto& owned = t_metrics_owner.metrics;
+
+    // 顺便释放已析构 Logger 的计数块：只剩本线程持有
+    owned.erase(std::remove_if(owned.begin(), owned.end(),
+                               [](const std::pair<uint64_t, std::shared_ptr<ProducerMetrics>>& entry) {
+        return entry.second.use_count() == 1;
+    }), owned.end());
+
+    ProducerMetrics* metrics = nullptr;
+    for (auto& entry : owned) {
+        if (entry.first == id_) {
+            metrics = entry.second.get();
+            break;
+        }
+    }
+    if (metrics == nullptr) {
+        auto created = std::make_shared<ProducerMetrics>();
+        {
+            std::lock_guard<std::mutex> lock(producers_mutex_);
+            producers_.push_back(created);
+        }
+        owned.emplace_back(id_, created);
+        metrics = created.get();
+    }
+
+    metrics_slot_.logger_id = id_;
+    metrics_slot_.metrics = metrics;
+    return metrics;
+}
+
+LoggerMetrics Logger::metrics(bool reset_peaks) {
+    LoggerMetrics result;
+    result.taken_at = std::chrono::steady_clock::now();
+
+    // 先读后台线程的计数再读生产者的计数，积压只会偏大而不会算成负数
+    for (auto& shard : shards_) {
+        result.records_written += shard->records_written.load();
+        result.bytes_written += shard->bytes_written.load();
+        result.batches_written += shard->batches_written.load();
+        const uint64_t peak = reset_peaks ? shard->max_queue_depth.exchange(0) : shard->max_queue_depth.load();
+        result.max_queue_depth = std::max(result.max_queue_depth, peak);
+        shard->write_lag.addTo(result.write_lag);
+        shard->flush_duration.addTo(result.flush_duration);
+        if (queue_mode_ == QueueMode::Shared) {
+            result.queue_depth += shard->log_queue.size();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(producers_mutex_);
+        auto it = std::remove_if(producers_.begin(), producers_.end(),
+                                 [this](const std::shared_ptr<ProducerMetrics>& metrics) {
+            // 与线程退出时的 release 配对，之后读到的是最终计数
+            if (!metrics->retired.load(std::memory_order_acquire)) {
+                return false;
+            }
+            retired_records_ += metrics->records.load();
+            metrics->enqueue_latency.addTo(retired_enqueue_latency_);
+            return true;
+        });
+        producers_.erase(it, producers_.end());
+
+        result.records_enqueued = retired_records_;
+        result.enqueue_latency = retired_enqueue_latency_;
+        for (const auto& metrics : producers_) {
+            result.records_enqueued += metrics->records.load();
+            metrics->enqueue_latency.addTo(result.enqueue_latency);
+        }
+    }
+    if (queue_mode_ == QueueMode::PerThread && result.records_enqueued > result.records_written) {
+        result.queue_depth = result.records_enqueued - result.records_written;
+    }
+
+    result.dropped = drops_.total();
+    for (size_t i = 0; i < kLogLevelCount; ++i) {
+        result.dropped_by_level[i] = drops_.count(static_cast<LogLevel>(i));
+    }
+    result.record_pool_overflows = buffer_pool_.overflowCount();
+    return result;
+}
@@ -0,0 +1,51 @@
+#include "logger_metrics.h"
+#include <algorithm>
+#include <cmath>
+
+uint64_t LatencyHistogram::count() const {
+    uint64_t total = 0;
+    for (uint64_t bucket : buckets) {
+        total += bucket;
+    }
+    return total;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    const uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    p = p < 0 ? 0 : (p > 1 ? 1 : p);
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p * static_cast<double>(total))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return (uint64_t(1) << (i + 1)) - 1;
+        }
+    }
+    return (uint64_t(1) << kBuckets) - 1;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < kBuckets; ++i) {
+        buckets[i] += other.buckets[i];
+    }
+}
+
+namespace {
+
+double perSecond(uint64_t later, uint64_t earlier, std::chrono::steady_clock::duration elapsed) {
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0 && later >= earlier ? static_cast<double>(later - earlier) / seconds : 0.0;
+}
+
+} // namespace
+
+double LoggerMetrics::bytesPerSecond(const LoggerMetrics& earlier) const {
+    return perSecond(bytes_written, earlier.bytes_written, taken_at - earlier.taken_at);
+}
+
+double LoggerMetrics::recordsPerSecond(const LoggerMetrics& earlier) const {
+    return perSecond(records_written, earlier.records_written, taken_at - earlier.taken_at);
+}
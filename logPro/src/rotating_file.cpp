@@ -0,0 +1,453 @@
+#include "rotating_file.h"
+#include <algorithm>
+#include <cstddef>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+size_t pageSize() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+size_t roundUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Mmap 方式下记录实际数据长度的旁路文件 <文件>.len，与数据页一样映射写入，进程崩溃后仍然有效
+constexpr char kLengthMagic[4] = {'L', 'P', 'M', 'L'};
+constexpr uint32_t kLengthVersion = 1;
+
+struct MappedLengthFile {
+    char magic[4];
+    uint32_t version;
+    uint64_t length;
+};
+
+std::string lengthPath(const std::string& log_path) {
+    return log_path + ".len";
+}
+
+} // namespace
+
+RotatingFile::RotatingFile(const std::string& filename, const RotationPolicy& policy,
+                           FileWriteMode mode, size_t mmap_segment_size, size_t index_interval)
+    : filename_(filename)
+    , policy_(policy)
+    , mode_(mode)
+    , mmap_segment_size_(roundUp(mmap_segment_size == 0 ? 1 : mmap_segment_size, pageSize()))
+    , index_interval_(index_interval) {
+    open();
+    if (policy_.compress && CompressionWorker::isSupported()) {
+        compressor_.reset(new CompressionWorker(policy_.compression_level,
+                                                policy_.max_compress_threads,
+                                                policy_.max_pending_compressions));
+    }
+}
+
+RotatingFile::~RotatingFile() {
+    close();
+    // compressor_ 析构时会压缩完已提交的日志段
+}
+
+bool RotatingFile::rotateIfNeeded() {
+    if (!shouldRotate()) {
+        return false;
+    }
+    rotate();
+    return true;
+}
+
+void RotatingFile::write(std::string_view data) {
+    writeAll(data.data(), data.size());
+}
+
+void RotatingFile::write(const std::string_view* parts, size_t count) {
+    if (mapped_) {
+        for (size_t i = 0; i < count; ++i) {
+            copyToMapping(parts[i].data(), parts[i].size());
+        }
+        return;
+    }
+
+    // 每次 writev 最多 kMaxIovecs 段，超出的部分分几次写完
+    constexpr int kMaxIovecs = 16;
+    iovec iov[kMaxIovecs];
+    size_t next = 0;
+    while (next < count) {
+        size_t total = 0;
+        int iov_count = 0;
+        for (; next < count && iov_count < kMaxIovecs; ++next) {
+            if (parts[next].empty()) {
+                continue;
+            }
+            iov[iov_count].iov_base = const_cast<char*>(parts[next].data());
+            iov[iov_count].iov_len = parts[next].size();
+            total += parts[next].size();
+            ++iov_count;
+        }
+        if (iov_count == 0) {
+            return;
+        }
+
+        ssize_t written;
+        do {
+            written = ::writev(fd_, iov, iov_count);
+        } while (written < 0 && errno == EINTR);
+        if (written < 0) {
+            std::cerr << "日志写入失败: " << std::strerror(errno) << std::endl;
+            return;
+        }
+        current_size_ += static_cast<size_t>(written);
+        bytes_written_ += static_cast<uint64_t>(written);
+        if (static_cast<size_t>(written) == total) {
+            continue;
+        }
+
+        // 部分写入：跳过已写出的字节，剩余部分逐段补写
+        size_t skip = static_cast<size_t>(written);
+        for (int i = 0; i < iov_count; ++i) {
+            if (skip >= iov[i].iov_len) {
+                skip -= iov[i].iov_len;
+                continue;
+            }
+            writeAll(static_cast<const char*>(iov[i].iov_base) + skip, iov[i].iov_len - skip);
+            skip = 0;
+        }
+    }
+}
+
+void RotatingFile::writeAll(const char* data, size_t size) {
+    if (mapped_) {
+        copyToMapping(data, size);
+        return;
+    }
+
+    const char* ptr = data;
+    size_t remaining = size;
+    while (remaining > 0) {
+        ssize_t written = ::write(fd_, ptr, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "日志写入失败: " << std::strerror(errno) << std::endl;
+            return;
+        }
+        ptr += written;
+        remaining -= static_cast<size_t>(written);
+        current_size_ += static_cast<size_t>(written);
+        bytes_written_ += static_cast<uint64_t>(written);
+    }
+}
+
+void RotatingFile::addIndexRange(const IndexRange& range) {
+    addIndexRange(range, current_size_ - std::min(index_covered_, current_size_));
+}
+
+void RotatingFile::addIndexRange(const IndexRange& range, size_t size) {
+    if (index_interval_ == 0) {
+        return;
+    }
+    index_covered_ = std::min(index_covered_ + size, current_size_);
+    index_chunk_.merge(range);
+    if (index_covered_ - index_chunk_start_ >= index_interval_) {
+        flushIndexEntry();
+    }
+}
+
+void RotatingFile::flushIndexEntry() {
+    if (index_chunk_.empty() || index_covered_ <= index_chunk_start_) {
+        return;
+    }
+    if (index_fd_ < 0) {
+        index_fd_ = ::open(logindex::indexPath(filename_).c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (index_fd_ < 0) {
+            std::cerr << "无法打开索引文件: " << std::strerror(errno) << std::endl;
+            return;
+        }
+        struct stat st;
+        if (::fstat(index_fd_, &st) == 0 && st.st_size == 0) {
+            logindex::IndexFileHeader header{};
+            std::memcpy(header.magic, logindex::kFileMagic, sizeof(header.magic));
+            header.version = logindex::kFileVersion;
+            if (::write(index_fd_, &header, sizeof(header)) != static_cast<ssize_t>(sizeof(header))) {
+                std::cerr << "索引写入失败: " << std::strerror(errno) << std::endl;
+            }
+        }
+    }
+
+    logindex::IndexEntry entry{};
+    entry.offset = index_chunk_start_;
+    entry.size = index_covered_ - index_chunk_start_;
+    entry.min_timestamp = index_chunk_.min_timestamp;
+    entry.max_timestamp = index_chunk_.max_timestamp;
+    entry.level_mask = index_chunk_.level_mask;
+    if (::write(index_fd_, &entry, sizeof(entry)) != static_cast<ssize_t>(sizeof(entry))) {
+        std::cerr << "索引写入失败: " << std::strerror(errno) << std::endl;
+    }
+    index_chunk_start_ = index_covered_;
+    index_chunk_ = IndexRange();
+}
+
+void RotatingFile::sync() {
+    // 先把当前映射窗口的脏页交给内核，再 fdatasync 覆盖之前已解除映射的段
+    if (mapped_ && map_ != nullptr) {
+        ::msync(map_, map_size_, MS_SYNC);
+    }
+#if defined(__APPLE__)
+    ::fsync(fd_);
+#else
+    ::fdatasync(fd_);
+#endif
+}
+
+void RotatingFile::rotate() {
+    close();
+
+    const std::string segment = nextSegmentName();
+    std::error_code ec;
+    fs::rename(filename_, segment, ec);
+    if (!ec && fs::exists(logindex::indexPath(filename_))) {
+        // 索引必须在提交压缩之前跟着日志段改名，压缩线程按它分帧
+        fs::rename(logindex::indexPath(filename_), logindex::indexPath(segment), ec);
+        if (ec) {
+            std::cerr << "索引改名失败: " << ec.message() << std::endl;
+            ec.clear();
+        }
+    }
+    if (ec) {
+        std::cerr << "日志轮转失败: " << ec.message() << std::endl;
+    } else if (compressor_ && !compressor_->submit(segment)) {
+        std::cerr << "压缩队列已满，日志段保持未压缩: " << segment << std::endl;
+    }
+
+    open();
+}
+
+bool RotatingFile::shouldRotate() const {
+    if (current_size_ == 0) {
+        return false;
+    }
+    if (policy_.max_file_size > 0 && current_size_ >= policy_.max_file_size) {
+        return true;
+    }
+    if (policy_.max_file_age.count() > 0 &&
+        std::chrono::steady_clock::now() - opened_at_ >= policy_.max_file_age) {
+        return true;
+    }
+    return false;
+}
+
+void RotatingFile::open() {
+    opened_at_ = std::chrono::steady_clock::now();
+    ++generation_;
+    if (mode_ == FileWriteMode::Mmap) {
+        openMapped();
+        return;
+    }
+    fd_ = ::open(filename_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Failed to open log file");
+    }
+    struct stat st;
+    const size_t file_size = ::fstat(fd_, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+    // 上次以 mmap 方式写入时崩溃：先截掉末尾预分配的 0 字节，否则新日志会接在这段空洞之后
+    current_size_ = recoverMappedSize(file_size);
+    if (current_size_ != file_size && ::ftruncate(fd_, static_cast<off_t>(current_size_)) != 0) {
+        std::cerr << "日志文件截断失败: " << std::strerror(errno) << std::endl;
+    }
+    ::unlink(lengthPath(filename_).c_str());
+    index_chunk_start_ = current_size_;
+    index_covered_ = current_size_;
+}
+
+void RotatingFile::close() {
+    // 最后一次报告之后写入的数据归入最后一条索引
+    index_covered_ = current_size_;
+    flushIndexEntry();
+    if (index_fd_ >= 0) {
+        ::close(index_fd_);
+        index_fd_ = -1;
+    }
+    if (mapped_) {
+        closeMapped();
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void RotatingFile::openMapped() {
+    fd_ = ::open(filename_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Failed to open log file");
+    }
+    struct stat st;
+    const size_t file_size = ::fstat(fd_, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+    current_size_ = recoverMappedSize(file_size);
+    index_chunk_start_ = current_size_;
+    index_covered_ = current_size_;
+    if (current_size_ != file_size && ::ftruncate(fd_, static_cast<off_t>(current_size_)) != 0) {
+        std::cerr << "日志文件截断失败: " << std::strerror(errno) << std::endl;
+    }
+
+    // 先记下长度再预分配：之后任何时刻崩溃，旁路文件中的长度都不会超过已写入的数据
+    mapped_ = openLengthFile() && mapWindow(current_size_);
+    if (!mapped_) {
+        closeLengthFile();
+        // 旁路文件没能接管时可能还是上次崩溃留下的，文件已按它截断，不能再留给下次打开
+        ::unlink(lengthPath(filename_).c_str());
+        // 退回 write 方式：O_APPEND 打开的描述符保证追加位置正确
+        ::close(fd_);
+        fd_ = ::open(filename_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            throw std::runtime_error("Failed to open log file");
+        }
+    }
+}
+
+void RotatingFile::closeMapped() {
+    if (map_ != nullptr) {
+        ::munmap(map_, map_size_);
+        map_ = nullptr;
+    }
+    // 去掉预分配但未写入的部分，截断之后文件长度本身就是准确的，不再需要旁路文件
+    if (::ftruncate(fd_, static_cast<off_t>(current_size_)) != 0) {
+        std::cerr << "日志文件截断失败: " << std::strerror(errno) << std::endl;
+    }
+    closeLengthFile();
+    mapped_ = false;
+}
+
+bool RotatingFile::openLengthFile() {
+    const std::string path = lengthPath(filename_);
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0 || ::ftruncate(fd, sizeof(MappedLengthFile)) != 0) {
+        std::cerr << "无法创建日志长度文件，改用 write 写入: " << std::strerror(errno) << std::endl;
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return false;
+    }
+    void* addr = ::mmap(nullptr, sizeof(MappedLengthFile), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        std::cerr << "日志长度文件映射失败，改用 write 写入: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    auto* file = static_cast<MappedLengthFile*>(addr);
+    file->length = current_size_;
+    file->version = kLengthVersion;
+    std::memcpy(file->magic, kLengthMagic, sizeof(file->magic));
+    mapped_length_ = &file->length;
+    return true;
+}
+
+void RotatingFile::closeLengthFile() {
+    if (mapped_length_ == nullptr) {
+        return;
+    }
+    ::munmap(reinterpret_cast<char*>(mapped_length_) - offsetof(MappedLengthFile, length), sizeof(MappedLengthFile));
+    mapped_length_ = nullptr;
+    ::unlink(lengthPath(filename_).c_str());
+}
+
+bool RotatingFile::mapWindow(size_t offset) {
+    if (map_ != nullptr) {
+        ::munmap(map_, map_size_);
+        map_ = nullptr;
+    }
+    const size_t window_offset = offset / pageSize() * pageSize();
+    const size_t window_size = mmap_segment_size_;
+
+    // 先真正分配磁盘块：稀疏文件在写映射页时才分配，磁盘满会触发 SIGBUS
+    int rc = ::posix_fallocate(fd_, static_cast<off_t>(window_offset), static_cast<off_t>(window_size));
+    if (rc != 0) {
+        std::cerr << "日志文件预分配失败，改用 write 写入: " << std::strerror(rc) << std::endl;
+        return false;
+    }
+    void* addr = ::mmap(nullptr, window_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_,
+                        static_cast<off_t>(window_offset));
+    if (addr == MAP_FAILED) {
+        std::cerr << "日志文件映射失败，改用 write 写入: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    map_ = static_cast<char*>(addr);
+    map_offset_ = window_offset;
+    map_size_ = window_size;
+    return true;
+}
+
+void RotatingFile::copyToMapping(const char* data, size_t size) {
+    while (size > 0) {
+        if (current_size_ >= map_offset_ + map_size_ && !mapWindow(current_size_)) {
+            // 映射下一段失败：截掉预分配部分，剩余数据改用 write 追加
+            closeMapped();
+            ::lseek(fd_, static_cast<off_t>(current_size_), SEEK_SET);
+            writeAll(data, size);
+            return;
+        }
+        const size_t position = current_size_ - map_offset_;
+        const size_t chunk = std::min(size, map_size_ - position);
+        std::memcpy(map_ + position, data, chunk);
+        data += chunk;
+        size -= chunk;
+        current_size_ += chunk;
+        bytes_written_ += chunk;
+        *mapped_length_ = current_size_;
+    }
+}
+
+size_t RotatingFile::recoverMappedSize(size_t file_size) {
+    // 上次进程崩溃时文件末尾留有预分配的部分，实际长度以旁路文件为准。
+    // 不能按末尾的 0 字节猜：二进制格式的记录本身可能以 0 结尾
+    int fd = ::open(lengthPath(filename_).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        // 上次正常关闭（或一直用 write 方式），文件长度就是实际长度
+        return file_size;
+    }
+    MappedLengthFile file{};
+    const bool valid = ::pread(fd, &file, sizeof(file), 0) == static_cast<ssize_t>(sizeof(file)) &&
+                       std::memcmp(file.magic, kLengthMagic, sizeof(file.magic)) == 0 &&
+                       file.version == kLengthVersion;
+    ::close(fd);
+    if (!valid) {
+        std::cerr << "日志长度文件无效，保留整个文件: " << lengthPath(filename_) << std::endl;
+        return file_size;
+    }
+    return static_cast<size_t>(std::min<uint64_t>(file.length, file_size));
+}
+
+std::string RotatingFile::nextSegmentName() {
+    std::time_t now = std::time(nullptr);
+    std::tm tm_buf;
+    localtime_r(&now, &tm_buf);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm_buf);
+
+    fs::path path(filename_);
+    const std::string base = (path.parent_path() / path.stem()).string() + "." + stamp + "-";
+    const std::string ext = path.extension().string();
+
+    // 同一秒内多次轮转时用序号区分，同时避开已存在的（压缩）段
+    std::string candidate;
+    do {
+        candidate = base + std::to_string(++sequence_) + ext;
+    } while (fs::exists(candidate) || fs::exists(candidate + ".zst"));
+    return candidate;
+}
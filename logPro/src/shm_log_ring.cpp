@@ -0,0 +1,224 @@
+#include "shm_log_ring.h"
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace shmlog {
+
+std::string segmentName(const std::string& channel, int pid, size_t shard) {
+    return "/" + std::string(kNamePrefix) + channel + "." + std::to_string(pid) + "." + std::to_string(shard);
+}
+
+} // namespace shmlog
+
+namespace {
+
+uint32_t magicValue() {
+    uint32_t value;
+    std::memcpy(&value, shmlog::kMagic, sizeof(value));
+    return value;
+}
+
+size_t roundUpPowerOfTwo(size_t n) {
+    size_t result = 4096;
+    while (result < n) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+ShmLogRing::~ShmLogRing() {
+    close();
+}
+
+bool ShmLogRing::create(const std::string& name, size_t capacity) {
+    name_ = name;
+    capacity_ = roundUpPowerOfTwo(capacity);
+    mask_ = capacity_ - 1;
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        // pid 被复用：之前同 pid 的进程退出时没有收集器在运行，留下的环直接替换
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0600);
+    }
+    if (fd < 0) {
+        error_ = "无法创建共享内存 " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    const size_t size = sizeof(shmlog::ShmRingHeader) + capacity_;
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0 || !map(fd, size)) {
+        error_ = "无法映射共享内存 " + name + ": " + std::strerror(errno);
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    ::close(fd);
+
+    header_ = new (mapping_) shmlog::ShmRingHeader();
+    header_->version = shmlog::kVersion;
+    header_->capacity = capacity_;
+    header_->pid = static_cast<int32_t>(getpid());
+    header_->magic.store(magicValue(), std::memory_order_release);
+    producer_ = true;
+    return true;
+}
+
+bool ShmLogRing::attach(const std::string& name) {
+    name_ = name;
+    int fd = shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0) {
+        error_ = "无法打开共享内存 " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) <= sizeof(shmlog::ShmRingHeader) ||
+        !map(fd, static_cast<size_t>(st.st_size))) {
+        ::close(fd);
+        error_ = "共享内存尚未初始化: " + name;
+        return false;
+    }
+    ::close(fd);
+
+    header_ = static_cast<shmlog::ShmRingHeader*>(mapping_);
+    if (header_->magic.load(std::memory_order_acquire) != magicValue() || header_->version != shmlog::kVersion ||
+        sizeof(shmlog::ShmRingHeader) + header_->capacity != mapping_size_) {
+        munmap(mapping_, mapping_size_);
+        mapping_ = nullptr;
+        header_ = nullptr;
+        error_ = "不是日志共享内存环或尚未初始化: " + name;
+        return false;
+    }
+    capacity_ = static_cast<size_t>(header_->capacity);
+    mask_ = capacity_ - 1;
+    consumer_head_ = header_->head.load(std::memory_order_acquire);
+    consumer_tail_cache_ = consumer_head_;
+    return true;
+}
+
+bool ShmLogRing::map(int fd, size_t size) {
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    mapping_ = mapping;
+    mapping_size_ = size;
+    return true;
+}
+
+void ShmLogRing::close() {
+    if (mapping_ == nullptr) {
+        return;
+    }
+    if (producer_) {
+        publish();
+        header_->closed.store(1, std::memory_order_release);
+    }
+    munmap(mapping_, mapping_size_);
+    mapping_ = nullptr;
+    header_ = nullptr;
+}
+
+void ShmLogRing::unlink() {
+    shm_unlink(name_.c_str());
+}
+
+int ShmLogRing::pid() const {
+    return header_ != nullptr ? header_->pid : 0;
+}
+
+bool ShmLogRing::producerClosed() const {
+    return header_ == nullptr || header_->closed.load(std::memory_order_acquire) != 0;
+}
+
+char* ShmLogRing::data() const {
+    return static_cast<char*>(mapping_) + sizeof(shmlog::ShmRingHeader);
+}
+
+bool ShmLogRing::append(uint64_t nanos, LogLevel level, std::string_view text) {
+    const size_t max_text = capacity_ / 2 - kLengthSize - sizeof(shmlog::ShmRecordHeader);
+    // 截断时保留结尾的换行，否则收集器会把这一行和下一条记录连在一起
+    bool add_newline = false;
+    if (text.size() > max_text) {
+        add_newline = text.back() == '\n';
+        text = text.substr(0, add_newline ? max_text - 1 : max_text);
+    }
+    const size_t size = sizeof(shmlog::ShmRecordHeader) + text.size() + (add_newline ? 1 : 0);
+    const size_t need = alignUp(kLengthSize + size);
+    uint64_t tail = producer_tail_;
+    size_t offset = static_cast<size_t>(tail & mask_);
+    const size_t to_end = capacity_ - offset;
+    const size_t total = need <= to_end ? need : to_end + need;
+
+    if (tail + total - producer_head_cache_ > capacity_) {
+        producer_head_cache_ = header_->head.load(std::memory_order_acquire);
+        if (tail + total - producer_head_cache_ > capacity_) {
+            return false;
+        }
+    }
+
+    char* ring = data();
+    if (need > to_end) {
+        std::memcpy(ring + offset, &kWrapMarker, sizeof(kWrapMarker));
+        tail += to_end;
+        offset = 0;
+    }
+    const uint64_t length = size;
+    shmlog::ShmRecordHeader record{nanos, static_cast<uint32_t>(level), 0};
+    std::memcpy(ring + offset, &length, sizeof(length));
+    std::memcpy(ring + offset + kLengthSize, &record, sizeof(record));
+    std::memcpy(ring + offset + kLengthSize + sizeof(record), text.data(), text.size());
+    if (add_newline) {
+        ring[offset + kLengthSize + sizeof(record) + text.size()] = '\n';
+    }
+    producer_tail_ = tail + need;
+    return true;
+}
+
+void ShmLogRing::publish() {
+    header_->tail.store(producer_tail_, std::memory_order_release);
+}
+
+size_t ShmLogRing::refresh() {
+    consumer_tail_cache_ = header_->tail.load(std::memory_order_acquire);
+    return static_cast<size_t>(consumer_tail_cache_ - consumer_head_);
+}
+
+bool ShmLogRing::front(shmlog::ShmRecordHeader& header, std::string_view& text) {
+    if (consumer_head_ == consumer_tail_cache_) {
+        return false;
+    }
+    const char* ring = data();
+    size_t offset = static_cast<size_t>(consumer_head_ & mask_);
+    uint64_t length;
+    std::memcpy(&length, ring + offset, sizeof(length));
+    if (length == kWrapMarker) {
+        consumer_head_ += capacity_ - offset;
+        offset = 0;
+        std::memcpy(&length, ring, sizeof(length));
+    }
+    if (length < sizeof(header) || length > capacity_ / 2) {
+        // 内容损坏，放弃本轮剩余的数据（随下一次 commit() 交还给生产者）
+        consumer_head_ = consumer_tail_cache_;
+        return false;
+    }
+    std::memcpy(&header, ring + offset + kLengthSize, sizeof(header));
+    text = std::string_view(ring + offset + kLengthSize + sizeof(header),
+                            static_cast<size_t>(length) - sizeof(header));
+    front_size_ = static_cast<size_t>(length);
+    return true;
+}
+
+void ShmLogRing::pop() {
+    consumer_head_ += alignUp(kLengthSize + front_size_);
+}
+
+void ShmLogRing::commit() {
+    header_->head.store(consumer_head_, std::memory_order_release);
+}
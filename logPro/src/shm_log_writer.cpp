@@ -0,0 +1,39 @@
+#include "shm_log_writer.h"
+#include <unistd.h>
+#include "shm_log_ring.h"
+
+ShmLogWriter::ShmLogWriter() = default;
+
+ShmLogWriter::~ShmLogWriter() {
+    close();
+}
+
+bool ShmLogWriter::open(const std::string& channel, size_t capacity) {
+    close();
+    auto ring = std::make_unique<ShmLogRing>();
+    if (!ring->create(shmlog::segmentName(channel, static_cast<int>(getpid()), 0), capacity)) {
+        error_ = ring->error();
+        return false;
+    }
+    ring_ = std::move(ring);
+    return true;
+}
+
+bool ShmLogWriter::write(uint64_t nanos, uint32_t level, const char* text, size_t length) {
+    if (ring_ == nullptr) {
+        return false;
+    }
+    const LogLevel log_level = level < kLogLevelCount ? static_cast<LogLevel>(level) : LogLevel::ERROR;
+    if (!ring_->append(nanos, log_level, std::string_view(text, length))) {
+        return false;
+    }
+    ring_->publish();
+    return true;
+}
+
+void ShmLogWriter::close() {
+    if (ring_ != nullptr) {
+        ring_->close();
+        ring_.reset();
+    }
+}
@@ -0,0 +1,55 @@
+#include "sink_channel.h"
+
+SinkChannel::SinkChannel(std::shared_ptr<LogSink> sink)
+    : sink_(std::move(sink)) {
+    worker_ = std::thread(&SinkChannel::run, this);
+}
+
+SinkChannel::~SinkChannel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_shutdown_ = true;
+    }
+    cond_var_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void SinkChannel::publish(const std::shared_ptr<const LogBatch>& batch) {
+    if (!sink_->accepts(batch->max_level)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pending_.size() >= sink_->maxPendingBatches()) {
+            sink_->addDropped(batch->lines.size());
+            return;
+        }
+        pending_.push_back(batch);
+    }
+    cond_var_.notify_one();
+}
+
+void SinkChannel::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        cond_var_.wait(lock, [this]() {
+            return !pending_.empty() || is_shutdown_;
+        });
+        if (pending_.empty()) {
+            return;
+        }
+        std::shared_ptr<const LogBatch> batch = std::move(pending_.front());
+        pending_.pop_front();
+        const bool drained = pending_.empty();
+
+        lock.unlock();
+        sink_->write(*batch);
+        batch.reset();
+        if (drained) {
+            sink_->flush();
+        }
+        lock.lock();
+    }
+}
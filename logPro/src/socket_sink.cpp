@@ -0,0 +1,174 @@
+#include "socket_sink.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int kConnectTimeoutMs = 1000;
+constexpr int kSendTimeoutMs = 1000;
+
+// 解析地址并创建套接字，UDP 直接 connect，TCP 带超时地 connect
+int openSocket(const std::string& host, uint16_t port, int socktype) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = socktype;
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &result) != 0) {
+        return -1;
+    }
+
+    int fd = -1;
+    for (addrinfo* ai = result; ai != nullptr && fd < 0; ai = ai->ai_next) {
+        fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        if (socktype == SOCK_DGRAM) {
+            if (::connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+                ::close(fd);
+                fd = -1;
+            }
+            continue;
+        }
+
+        int flags = fcntl(fd, F_GETFL, 0);
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        int rc = ::connect(fd, ai->ai_addr, ai->ai_addrlen);
+        if (rc != 0 && errno == EINPROGRESS) {
+            pollfd pfd{fd, POLLOUT, 0};
+            int error = 0;
+            socklen_t length = sizeof(error);
+            if (poll(&pfd, 1, kConnectTimeoutMs) == 1 &&
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0) {
+                rc = 0;
+            }
+        }
+        if (rc != 0) {
+            ::close(fd);
+            fd = -1;
+            continue;
+        }
+        fcntl(fd, F_SETFL, flags);
+        timeval timeout{kSendTimeoutMs / 1000, (kSendTimeoutMs % 1000) * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    }
+    freeaddrinfo(result);
+    return fd;
+}
+
+size_t countLines(std::string_view text) {
+    return static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+}
+
+} // namespace
+
+UdpSink::UdpSink(const std::string& host, uint16_t port, LogLevel level, size_t max_datagram)
+    : LogSink(level)
+    , max_datagram_(max_datagram == 0 ? 1400 : max_datagram) {
+    fd_ = openSocket(host, port, SOCK_DGRAM);
+    pending_.reserve(max_datagram_);
+}
+
+UdpSink::~UdpSink() {
+    if (fd_ >= 0) {
+        flush();
+        ::close(fd_);
+    }
+}
+
+void UdpSink::writeText(std::string_view text) {
+    if (fd_ < 0) {
+        addDropped(countLines(text));
+        return;
+    }
+    while (!text.empty()) {
+        size_t newline = text.find('\n');
+        size_t length = newline == std::string_view::npos ? text.size() : newline + 1;
+        std::string_view line = text.substr(0, length);
+        text.remove_prefix(length);
+
+        if (pending_.size() + line.size() > max_datagram_) {
+            flush();
+        }
+        if (line.size() > max_datagram_) {
+            send(line.substr(0, max_datagram_));
+            continue;
+        }
+        pending_.append(line.data(), line.size());
+    }
+}
+
+void UdpSink::flush() {
+    if (!pending_.empty()) {
+        send(pending_);
+        pending_.clear();
+    }
+}
+
+void UdpSink::send(std::string_view datagram) {
+    if (::send(fd_, datagram.data(), datagram.size(), MSG_DONTWAIT) < 0) {
+        addDropped(std::max<size_t>(1, countLines(datagram)));
+    }
+}
+
+TcpSink::TcpSink(const std::string& host, uint16_t port, LogLevel level,
+                 std::chrono::milliseconds reconnect_interval)
+    : LogSink(level)
+    , host_(host)
+    , port_(port)
+    , reconnect_interval_(reconnect_interval)
+    , next_attempt_(std::chrono::steady_clock::now()) {}
+
+TcpSink::~TcpSink() {
+    disconnect();
+}
+
+bool TcpSink::ensureConnected() {
+    if (fd_ >= 0) {
+        return true;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now < next_attempt_) {
+        return false;
+    }
+    fd_ = openSocket(host_, port_, SOCK_STREAM);
+    if (fd_ < 0) {
+        next_attempt_ = now + reconnect_interval_;
+        return false;
+    }
+    return true;
+}
+
+void TcpSink::disconnect() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    next_attempt_ = std::chrono::steady_clock::now() + reconnect_interval_;
+}
+
+void TcpSink::writeText(std::string_view text) {
+    if (!ensureConnected()) {
+        addDropped(countLines(text));
+        return;
+    }
+    while (!text.empty()) {
+        ssize_t sent = ::send(fd_, text.data(), text.size(), MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // 对端断开或发送超时：丢弃本批剩余部分，稍后重连
+            addDropped(countLines(text));
+            disconnect();
+            return;
+        }
+        text.remove_prefix(static_cast<size_t>(sent));
+    }
+}
@@ -0,0 +1,227 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cerrno>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include <signal.h>
+#include "log_index.h"
+#include "rotating_file.h"
+#include "shm_log_ring.h"
+
+// 日志收集守护进程：汇总同一 channel 下所有进程的共享内存环（LoggerOptions::shm_channel），
+// 按时间戳归并后写入一个文件，轮转、zstd 压缩和时间索引与 Logger 直接写文件时相同。
+//
+// 每 500ms 扫描一次 /dev/shm 中的 logpro.<channel>.* 发现新进程；生产者关闭或进程已不存在、
+// 且环已取空时删除该环。消费位置保存在共享内存中，每批写入文件后才提交，收集器重启后从上次提交的位置继续。
+// SIGINT/SIGTERM 时取空所有环后退出
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void usage() {
+    std::cerr << "用法: logcollector --channel 名称 -o 输出文件 [--max-size MB] [--max-age 秒] [--no-compress] [--no-index]\n";
+}
+
+struct Options {
+    std::string channel;
+    std::string output;
+    RotationPolicy rotation;
+    size_t index_interval = 64 * 1024;
+};
+
+bool parseArgs(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--channel" && has_value) {
+            options.channel = argv[++i];
+        } else if (arg == "-o" && has_value) {
+            options.output = argv[++i];
+        } else if (arg == "--max-size" && has_value) {
+            options.rotation.max_file_size = std::stoull(argv[++i]) * 1024 * 1024;
+        } else if (arg == "--max-age" && has_value) {
+            options.rotation.max_file_age = std::chrono::seconds(std::stoll(argv[++i]));
+        } else if (arg == "--no-compress") {
+            options.rotation.compress = false;
+        } else if (arg == "--no-index") {
+            options.index_interval = 0;
+        } else {
+            return false;
+        }
+    }
+    return !options.channel.empty() && !options.output.empty();
+}
+
+std::atomic<bool> g_stop{false};
+
+void onSignal(int) {
+    g_stop.store(true);
+}
+
+constexpr auto kScanInterval = std::chrono::milliseconds(500);
+constexpr auto kIdleSleep = std::chrono::milliseconds(1);
+constexpr size_t kWriteThreshold = 1024 * 1024;
+
+bool processAlive(int pid) {
+    return pid > 0 && (::kill(pid, 0) == 0 || errno == EPERM);
+}
+
+class Collector {
+public:
+    explicit Collector(const Options& options)
+        : options_(options)
+        , file_(options.output, options.rotation, FileWriteMode::Write, 16 * 1024 * 1024, options.index_interval) {
+        batch_.reserve(kWriteThreshold + 64 * 1024);
+    }
+
+    // 发现新出现的环
+    void scan() {
+        const std::string prefix = std::string(shmlog::kNamePrefix) + options_.channel + ".";
+        std::error_code ec;
+        for (const auto& entry : fs::directory_iterator("/dev/shm", ec)) {
+            const std::string name = entry.path().filename().string();
+            if (name.compare(0, prefix.size(), prefix) != 0 || rings_.count(name) != 0) {
+                continue;
+            }
+            auto ring = std::make_unique<ShmLogRing>();
+            // 对方还在初始化时 attach 失败，下次扫描再试
+            if (ring->attach("/" + name)) {
+                rings_.emplace(name, std::move(ring));
+            }
+        }
+    }
+
+    // 取空各环在刷新时刻已发布的记录，按时间戳归并写出，返回记录数
+    size_t drain() {
+        using Head = std::pair<uint64_t, ShmLogRing*>;
+        std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+        shmlog::ShmRecordHeader header;
+        std::string_view text;
+        for (auto& [name, ring] : rings_) {
+            if (ring->refresh() > 0 && ring->front(header, text)) {
+                heads.emplace(header.nanos, ring.get());
+            }
+        }
+
+        size_t count = 0;
+        while (!heads.empty()) {
+            ShmLogRing* ring = heads.top().second;
+            heads.pop();
+            ring->front(header, text);
+            batch_.append(text.data(), text.size());
+            range_.add(header.nanos, static_cast<LogLevel>(header.level < kLogLevelCount ? header.level : 0));
+            range_bytes_ += text.size();
+            // 本批第一段还要算上上一批留在当前索引条目中的字节
+            const size_t carried = pending_ranges_.empty() ? file_.indexChunkBytes() : 0;
+            if (options_.index_interval > 0 && carried + range_bytes_ >= options_.index_interval) {
+                // 一批最多 kWriteThreshold 字节，按约 index_interval 字节分段报告索引范围
+                pending_ranges_.emplace_back(range_, range_bytes_);
+                range_ = IndexRange();
+                range_bytes_ = 0;
+            }
+            ring->pop();
+            ++count;
+            if (batch_.size() >= kWriteThreshold) {
+                write();
+            }
+            if (ring->front(header, text)) {
+                heads.emplace(header.nanos, ring);
+            }
+        }
+        write();
+        records_ += count;
+        return count;
+    }
+
+    // 删除生产者已关闭（或进程已退出）且已取空的环
+    void retire() {
+        for (auto it = rings_.begin(); it != rings_.end();) {
+            ShmLogRing& ring = *it->second;
+            // 先读关闭标志再看是否还有数据：关闭前的最后一次发布一定能看到
+            const bool finished = ring.producerClosed() || !processAlive(ring.pid());
+            if (finished && ring.refresh() == 0) {
+                ring.unlink();
+                it = rings_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    size_t ringCount() const { return rings_.size(); }
+    uint64_t records() const { return records_; }
+
+private:
+    void write() {
+        if (!batch_.empty()) {
+            file_.rotateIfNeeded();
+            file_.write(batch_);
+            for (const auto& [range, bytes] : pending_ranges_) {
+                file_.addIndexRange(range, bytes);
+            }
+            file_.addIndexRange(range_);
+            batch_.clear();
+            pending_ranges_.clear();
+            range_ = IndexRange();
+            range_bytes_ = 0;
+        }
+        // 写入文件之后才提交消费位置：收集器在两者之间崩溃时重启后重新读取这一批，不会丢
+        for (auto& [name, ring] : rings_) {
+            ring->commit();
+        }
+    }
+
+    const Options& options_;
+    RotatingFile file_;
+    std::map<std::string, std::unique_ptr<ShmLogRing>> rings_;
+    std::string batch_;
+    IndexRange range_;
+    size_t range_bytes_ = 0;
+    std::vector<std::pair<IndexRange, size_t>> pending_ranges_;  // 本批中已满 index_interval 的各段
+    uint64_t records_ = 0;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        if (!parseArgs(argc, argv, options)) {
+            usage();
+            return 2;
+        }
+    } catch (const std::exception&) {
+        usage();
+        return 2;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    Collector collector(options);
+    auto next_scan = std::chrono::steady_clock::now();
+    while (!g_stop.load()) {
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= next_scan) {
+            collector.scan();
+            collector.retire();
+            next_scan = now + kScanInterval;
+        }
+        if (collector.drain() == 0) {
+            std::this_thread::sleep_for(kIdleSleep);
+        }
+    }
+    collector.drain();
+    collector.retire();
+    std::cerr << "logcollector: " << collector.records() << " records, "
+              << collector.ringCount() << " rings still attached\n";
+    return 0;
+}
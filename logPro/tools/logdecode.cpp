@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "binary_log_reader.h"
+#include "tool_common.h"
+
+// 把 Logger 以 LogFormat::Binary 写出的日志还原为文本格式
+// 先顺序扫描块头和字典，再由多个线程并行解码各块，按块顺序输出
+
+namespace {
+
+void usage() {
+    std::cerr << "用法: logdecode [-j 线程数] [--level INFO,ERROR] [--from \"YYYY-mm-dd HH:MM:SS\"]\n"
+                 "                 [--to \"YYYY-mm-dd HH:MM:SS\"] [--nanos] [--json] [-o 输出文件] 文件...\n";
+}
+
+struct Options {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    RecordFilter filter;
+    TimestampPrecision precision = TimestampPrecision::Micro;
+    bool json = false;      // 输出 JSON 行（ts、level、msg 和各字段）
+    std::string output;
+    std::vector<std::string> files;
+};
+
+bool parseArgs(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "-j" && has_value) {
+            options.threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--level" && has_value) {
+            if (!parseLevelMask(argv[++i], options.filter.level_mask)) {
+                std::cerr << "无效的级别列表: " << argv[i] << "\n";
+                return false;
+            }
+        } else if ((arg == "--from" || arg == "--to") && has_value) {
+            uint64_t& bound = arg == "--from" ? options.filter.from : options.filter.to;
+            if (!parseTimestamp(argv[++i], bound)) {
+                std::cerr << "无效的时间: " << argv[i] << "\n";
+                return false;
+            }
+        } else if (arg == "--nanos") {
+            options.precision = TimestampPrecision::Nano;
+        } else if (arg == "--json") {
+            options.json = true;
+        } else if (arg == "-o" && has_value) {
+            options.output = argv[++i];
+        } else if (!arg.empty() && arg[0] == '-') {
+            return false;
+        } else {
+            options.files.push_back(arg);
+        }
+    }
+    return !options.files.empty();
+}
+
+// 以 threads × 4 个块为一个窗口并行解码，窗口内按顺序写出，内存占用与文件大小无关
+void decodeFile(const BinaryLogReader& reader, const Options& options, FILE* out) {
+    const auto& blocks = reader.blocks();
+    const size_t window = options.threads * 4;
+    std::vector<std::string> outputs(window);
+
+    for (size_t first = 0; first < blocks.size(); first += window) {
+        const size_t count = std::min(window, blocks.size() - first);
+        std::atomic<size_t> next{0};
+
+        auto work = [&]() {
+            TimestampFormatter formatter(options.precision);
+            size_t index;
+            while ((index = next.fetch_add(1, std::memory_order_relaxed)) < count) {
+                outputs[index].clear();
+                reader.decodeBlock(blocks[first + index], options.filter, formatter, outputs[index], options.json);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        const size_t extra = std::min<size_t>(options.threads, count) - 1;
+        for (size_t i = 0; i < extra; ++i) {
+            workers.emplace_back(work);
+        }
+        work();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            std::fwrite(outputs[i].data(), 1, outputs[i].size(), out);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+
+    FILE* out = stdout;
+    if (!options.output.empty()) {
+        out = std::fopen(options.output.c_str(), "w");
+        if (out == nullptr) {
+            std::cerr << "无法创建输出文件: " << options.output << "\n";
+            return 1;
+        }
+    }
+
+    int status = 0;
+    for (const auto& path : options.files) {
+        BinaryLogReader reader;
+        if (!reader.open(path)) {
+            std::cerr << reader.error() << "\n";
+            status = 1;
+            continue;
+        }
+        if (!reader.error().empty()) {
+            std::cerr << path << ": " << reader.error() << "\n";
+            status = 1;
+        }
+        decodeFile(reader, options, out);
+    }
+
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    return status;
+}
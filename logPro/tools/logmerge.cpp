@@ -0,0 +1,212 @@
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "binary_log_reader.h"
+#include "tool_common.h"
+
+// 把分片模式（LoggerOptions::backend_threads > 1）下各后台线程写出的文件按时间戳归并成一份
+// 每个分片文件本身已按时间排序，这里只做多路归并；时间相同的记录按文件在命令行中的顺序输出。
+// 文本文件直接映射后逐条读取，二进制文件逐块解码成文本后再归并，可以混合输入。
+// 一条记录从级别标签开始，到下一个以级别标签开头的行为止，消息中的换行不会把记录拆开
+
+namespace {
+
+void usage() {
+    std::cerr << "用法: logmerge [--nanos] [-o 输出文件] 文件...\n"
+                 "       logmerge app.0.log app.1.log app.2.log app.3.log > app.log\n";
+}
+
+struct Options {
+    TimestampPrecision precision = TimestampPrecision::Micro;
+    std::string output;
+    std::vector<std::string> files;
+};
+
+bool parseArgs(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--nanos") {
+            options.precision = TimestampPrecision::Nano;
+        } else if (arg == "-o" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (!arg.empty() && arg[0] == '-') {
+            return false;
+        } else {
+            options.files.push_back(arg);
+        }
+    }
+    return !options.files.empty();
+}
+
+// 一个输入文件，按顺序给出记录及其排序键（级别标签后的 "日期 时间"）
+class RecordSource {
+public:
+    explicit RecordSource(TimestampPrecision precision)
+        : formatter_(precision) {}
+
+    ~RecordSource() {
+        if (mapping_ != nullptr) {
+            munmap(mapping_, size_);
+        }
+    }
+
+    RecordSource(const RecordSource&) = delete;
+    RecordSource& operator=(const RecordSource&) = delete;
+
+    bool open(const std::string& path, std::string& error) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            error = "无法打开文件: " + path;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            error = "无法读取文件信息: " + path;
+            return false;
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ > 0) {
+            mapping_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd);
+        if (mapping_ == MAP_FAILED) {
+            mapping_ = nullptr;
+            error = "无法映射文件: " + path;
+            return false;
+        }
+        if (mapping_ == nullptr) {
+            return true;    // 空文件
+        }
+
+        const char* data = static_cast<const char*>(mapping_);
+        if (size_ < sizeof(binlog::kFileMagic) ||
+            std::memcmp(data, binlog::kFileMagic, sizeof(binlog::kFileMagic)) != 0) {
+            chunk_ = std::string_view(data, size_);
+            madvise(mapping_, size_, MADV_SEQUENTIAL);
+            return true;
+        }
+
+        munmap(mapping_, size_);
+        mapping_ = nullptr;
+        binary_ = std::make_unique<BinaryLogReader>();
+        if (!binary_->open(path)) {
+            error = binary_->error();
+            return false;
+        }
+        if (!binary_->error().empty()) {
+            std::cerr << path << ": " << binary_->error() << "\n";
+        }
+        return true;
+    }
+
+    // 前进到下一条记录，没有更多记录时返回 false
+    bool next() {
+        while (pos_ >= chunk_.size()) {
+            if (!decodeNextBlock()) {
+                return false;
+            }
+        }
+        pos_ = nextRecord(chunk_, pos_, record_);
+        key_ = recordTimestamp(record_);
+        return true;
+    }
+
+    std::string_view record() const { return record_; }
+    std::string_view key() const { return key_; }
+
+private:
+    bool decodeNextBlock() {
+        if (binary_ == nullptr || next_block_ >= binary_->blocks().size()) {
+            return false;
+        }
+        decoded_.clear();
+        binary_->decodeBlock(binary_->blocks()[next_block_++], RecordFilter(), formatter_, decoded_);
+        chunk_ = decoded_;
+        pos_ = 0;
+        return true;
+    }
+
+    void* mapping_ = nullptr;
+    size_t size_ = 0;
+    std::unique_ptr<BinaryLogReader> binary_;
+    size_t next_block_ = 0;
+    std::string decoded_;
+    TimestampFormatter formatter_;
+
+    std::string_view chunk_;
+    size_t pos_ = 0;
+    std::string_view record_;
+    std::string_view key_;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+
+    std::vector<std::unique_ptr<RecordSource>> sources;
+    for (const auto& path : options.files) {
+        auto source = std::make_unique<RecordSource>(options.precision);
+        std::string error;
+        if (!source->open(path, error)) {
+            std::cerr << error << "\n";
+            return 1;
+        }
+        sources.push_back(std::move(source));
+    }
+
+    FILE* out = stdout;
+    if (!options.output.empty()) {
+        out = std::fopen(options.output.c_str(), "w");
+        if (out == nullptr) {
+            std::cerr << "无法创建输出文件: " << options.output << "\n";
+            return 1;
+        }
+    }
+    static char out_buffer[1 << 20];
+    std::setvbuf(out, out_buffer, _IOFBF, sizeof(out_buffer));
+
+    // 小顶堆：时间最早的记录在堆顶，时间相同时文件序号小的在前
+    auto later = [&](size_t a, size_t b) {
+        const int order = sources[a]->key().compare(sources[b]->key());
+        return order != 0 ? order > 0 : a > b;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heap(later);
+    for (size_t i = 0; i < sources.size(); ++i) {
+        if (sources[i]->next()) {
+            heap.push(i);
+        }
+    }
+    while (!heap.empty()) {
+        const size_t index = heap.top();
+        heap.pop();
+        std::string_view record = sources[index]->record();
+        std::fwrite(record.data(), 1, record.size(), out);
+        if (record.back() != '\n') {
+            std::fputc('\n', out);     // 文件最后一行没有换行符
+        }
+        if (sources[index]->next()) {
+            heap.push(index);
+        }
+    }
+
+    std::fflush(out);
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    return 0;
+}
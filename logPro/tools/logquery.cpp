@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "binary_log_reader.h"
+#include "log_index.h"
+#include "tool_common.h"
+
+// 按时间范围和级别查询日志目录，只读取索引命中的数据块
+//
+// 文本日志段（包括轮转时按帧压缩的 .zst）用旁边的 .idx 定位：二分查找起始块，
+// 跳过时间范围或级别不相交的块，只解压/读取命中的块，再逐条过滤。
+// 二进制日志的块头本身带有时间范围，直接用 BinaryLogReader 跳过不相交的块。
+// 目录参数展开为其中的日志文件，按各文件最早的时间戳排序后依次查询
+
+namespace fs = std::filesystem;
+
+namespace {
+
+void usage() {
+    std::cerr << "用法: logquery [--from \"YYYY-mm-dd HH:MM:SS\"] [--to \"YYYY-mm-dd HH:MM:SS\"]\n"
+                 "                [--level WARN,ERROR] [--nanos] [--stats] [-o 输出文件] 文件或目录...\n";
+}
+
+struct Options {
+    RecordFilter filter;
+    bool has_from = false;
+    bool has_to = false;
+    TimestampPrecision precision = TimestampPrecision::Micro;
+    bool stats = false;
+    std::string output;
+    std::vector<std::string> paths;
+};
+
+bool parseArgs(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--level" && has_value) {
+            if (!parseLevelMask(argv[++i], options.filter.level_mask)) {
+                std::cerr << "无效的级别列表: " << argv[i] << "\n";
+                return false;
+            }
+        } else if ((arg == "--from" || arg == "--to") && has_value) {
+            const bool from = arg == "--from";
+            if (!parseTimestamp(argv[++i], from ? options.filter.from : options.filter.to)) {
+                std::cerr << "无效的时间: " << argv[i] << "\n";
+                return false;
+            }
+            (from ? options.has_from : options.has_to) = true;
+        } else if (arg == "--nanos") {
+            options.precision = TimestampPrecision::Nano;
+        } else if (arg == "--stats") {
+            options.stats = true;
+        } else if (arg == "-o" && has_value) {
+            options.output = argv[++i];
+        } else if (!arg.empty() && arg[0] == '-') {
+            return false;
+        } else {
+            options.paths.push_back(arg);
+        }
+    }
+    return !options.paths.empty();
+}
+
+bool isBinaryLog(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(binlog::kFileMagic)];
+    return in.read(magic, sizeof(magic)) && std::memcmp(magic, binlog::kFileMagic, sizeof(magic)) == 0;
+}
+
+struct Stats {
+    size_t files = 0;
+    size_t chunks_total = 0;
+    size_t chunks_read = 0;
+    uint64_t bytes_read = 0;
+    size_t records = 0;
+};
+
+// 逐条比较记录的时间戳文本。界限按纳秒精度格式化，截到与记录相同的长度再比较，
+// 所以微秒精度的日志按微秒判断边界
+class TextQuery {
+public:
+    explicit TextQuery(const Options& options)
+        : options_(options) {
+        TimestampFormatter formatter(TimestampPrecision::Nano);
+        if (options.has_from) {
+            formatter.append(options.filter.from, from_);
+        }
+        if (options.has_to) {
+            formatter.append(options.filter.to, to_);
+        }
+    }
+
+    void run(const std::string& path, FILE* out, Stats& stats) {
+        IndexedLogReader reader;
+        if (!reader.open(path)) {
+            std::cerr << reader.error() << "\n";
+            return;
+        }
+        const auto& chunks = reader.chunks();
+        stats.chunks_total += chunks.size();
+        std::string buffer;
+        for (size_t index : reader.select(options_.filter.from, options_.filter.to, options_.filter.level_mask)) {
+            std::string_view text;
+            if (!reader.read(chunks[index], buffer, text)) {
+                std::cerr << path << ": 解压失败，偏移 " << chunks[index].offset << "\n";
+                continue;
+            }
+            ++stats.chunks_read;
+            stats.bytes_read += text.size();
+            filter(text, out, stats);
+        }
+    }
+
+private:
+    void filter(std::string_view text, FILE* out, Stats& stats) const {
+        std::string_view record;
+        for (size_t pos = 0; pos < text.size();) {
+            pos = nextRecord(text, pos, record);
+            const size_t tag = recordTagLength(record);
+            if (tag == 0 || !acceptsLevel(record.substr(0, tag)) || !acceptsTime(recordTimestamp(record))) {
+                continue;
+            }
+            std::fwrite(record.data(), 1, record.size(), out);
+            ++stats.records;
+        }
+    }
+
+    bool acceptsLevel(std::string_view tag) const {
+        for (size_t i = 0; i < kLogLevelCount; ++i) {
+            if (tag == levelTag(static_cast<LogLevel>(i))) {
+                return options_.filter.acceptsLevel(static_cast<LogLevel>(i));
+            }
+        }
+        return false;
+    }
+
+    bool acceptsTime(std::string_view timestamp) const {
+        if (options_.has_from && timestamp < std::string_view(from_).substr(0, timestamp.size())) {
+            return false;
+        }
+        if (options_.has_to && timestamp > std::string_view(to_).substr(0, timestamp.size())) {
+            return false;
+        }
+        return true;
+    }
+
+    const Options& options_;
+    std::string from_;
+    std::string to_;
+};
+
+void queryBinary(const std::string& path, const Options& options, FILE* out, Stats& stats) {
+    BinaryLogReader reader;
+    if (!reader.open(path)) {
+        std::cerr << reader.error() << "\n";
+        return;
+    }
+    TimestampFormatter formatter(options.precision);
+    std::string text;
+    for (const auto& block : reader.blocks()) {
+        ++stats.chunks_total;
+        if (block.header.max_timestamp < options.filter.from || block.header.min_timestamp > options.filter.to) {
+            continue;
+        }
+        ++stats.chunks_read;
+        stats.bytes_read += block.header.records_size;
+        text.clear();
+        stats.records += reader.decodeBlock(block, options.filter, formatter, text);
+        std::fwrite(text.data(), 1, text.size(), out);
+    }
+}
+
+// 展开目录，按最早时间戳排序（没有索引的文件用修改时间）
+std::vector<std::string> collectFiles(const std::vector<std::string>& paths) {
+    std::vector<std::string> files;
+    for (const auto& path : paths) {
+        std::error_code ec;
+        if (!fs::is_directory(path, ec)) {
+            files.push_back(path);
+            continue;
+        }
+        std::vector<std::pair<uint64_t, std::string>> found;
+        for (const auto& entry : fs::directory_iterator(path, ec)) {
+            const std::string file = entry.path().string();
+            if (!entry.is_regular_file() || entry.path().extension() == ".idx" ||
+                entry.path().extension() == ".len") {
+                continue;
+            }
+            uint64_t first = 0;
+            IndexedLogReader reader;
+            if (!isBinaryLog(file) && reader.open(file)) {
+                first = reader.firstTimestamp();
+            }
+            if (first == 0) {
+                first = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    entry.last_write_time().time_since_epoch()).count());
+            }
+            found.emplace_back(first, file);
+        }
+        std::sort(found.begin(), found.end());
+        for (auto& item : found) {
+            files.push_back(std::move(item.second));
+        }
+    }
+    return files;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        usage();
+        return 2;
+    }
+
+    FILE* out = stdout;
+    if (!options.output.empty()) {
+        out = std::fopen(options.output.c_str(), "w");
+        if (out == nullptr) {
+            std::cerr << "无法创建输出文件: " << options.output << "\n";
+            return 1;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    Stats stats;
+    TextQuery text_query(options);
+    for (const auto& file : collectFiles(options.paths)) {
+        ++stats.files;
+        if (isBinaryLog(file)) {
+            queryBinary(file, options, out, stats);
+        } else {
+            text_query.run(file, out, stats);
+        }
+    }
+    std::fflush(out);
+    if (out != stdout) {
+        std::fclose(out);
+    }
+
+    if (options.stats) {
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::fprintf(stderr, "files %zu, chunks %zu/%zu, bytes read %llu, records %zu, %.3f s\n",
+                     stats.files, stats.chunks_read, stats.chunks_total,
+                     static_cast<unsigned long long>(stats.bytes_read), stats.records, elapsed);
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+#ifndef TOOL_COMMON_H
+#define TOOL_COMMON_H
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include "log_record.h"
+
+// 离线工具共用的参数解析
+
+// 解析 "INFO,ERROR" 形式的级别列表为位掩码，未知级别返回 false
+inline bool parseLevelMask(std::string_view list, uint32_t& mask) {
+    mask = 0;
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view name = list.substr(0, comma);
+        LogLevel level;
+        if (!parseLevel(name, level)) {
+            return false;
+        }
+        mask |= 1u << static_cast<int>(level);
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+    }
+    return mask != 0;
+}
+
+// 解析本地时间 "YYYY-mm-dd HH:MM:SS[.fraction]" 为自 epoch 起的纳秒
+inline bool parseTimestamp(const std::string& text, uint64_t& nanos) {
+    std::tm tm{};
+    const char* rest = strptime(text.c_str(), "%Y-%m-%d %H:%M:%S", &tm);
+    if (rest == nullptr) {
+        return false;
+    }
+    tm.tm_isdst = -1;
+    std::time_t seconds = std::mktime(&tm);
+    if (seconds < 0) {
+        return false;
+    }
+    uint64_t fraction = 0;
+    if (*rest == '.') {
+        ++rest;
+        uint64_t scale = 100000000;
+        for (; *rest >= '0' && *rest <= '9'; ++rest) {
+            fraction += static_cast<uint64_t>(*rest - '0') * scale;
+            scale /= 10;
+        }
+    }
+    if (*rest != '\0') {
+        return false;
+    }
+    nanos = static_cast<uint64_t>(seconds) * 1000000000ull + fraction;
+    return true;
+}
+
+// 文本日志中一条记录以级别标签开头，返回标签长度；不是记录开头（消息中的续行）时返回 0
+inline size_t recordTagLength(std::string_view line) {
+    for (size_t i = 0; i < kLogLevelCount; ++i) {
+        std::string_view tag = levelTag(static_cast<LogLevel>(i));
+        if (line.substr(0, tag.size()) == tag) {
+            return tag.size();
+        }
+    }
+    return 0;
+}
+
+// 从 text 的 pos 处取出一条记录（包括续行），返回下一条记录的位置
+inline size_t nextRecord(std::string_view text, size_t pos, std::string_view& record) {
+    auto lineEnd = [&](size_t from) {
+        const size_t newline = text.find('\n', from);
+        return newline == std::string_view::npos ? text.size() : newline + 1;
+    };
+    size_t end = lineEnd(pos);
+    while (end < text.size() && recordTagLength(text.substr(end)) == 0) {
+        end = lineEnd(end);
+    }
+    record = text.substr(pos, end - pos);
+    return end;
+}
+
+// 记录的时间戳文本（"日期 时间"），同一精度下可以直接按字典序比较
+inline std::string_view recordTimestamp(std::string_view record) {
+    const size_t tag = recordTagLength(record);
+    if (tag == 0) {
+        return std::string_view();
+    }
+    const size_t date_end = record.find(' ', tag);
+    const size_t time_end = date_end == std::string_view::npos ? date_end : record.find(' ', date_end + 1);
+    return record.substr(tag, time_end == std::string_view::npos ? std::string_view::npos : time_end - tag);
+}
+
+#endif // TOOL_COMMON_H